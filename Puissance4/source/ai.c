@@ -11,13 +11,163 @@
 
 #include <assert.h>
 #include <stdlib.h>
+#include <pthread.h>
 
 #include "model.h"
 #include "ai.h"
+#include "transposition.h"
+#include "book.h"
+#include "evaluation.h"
+#include "grid.h"
+#include "timing.h"
+
+//Number of nodes a search should roughly stay under with a fixed depth
+#define NODES_BUDGET 200000
+//The clock is read every CHECK_NODES nodes (must be a power of 2)
+#define CHECK_NODES 256
+//The evaluation of a position stays far from the scores of the wins
+#define MAX_EVALUATION (SCORE_WIN / 2)
+
+/**
+ * @brief Implementation of the data shared by the nodes of a search
+ */
+typedef struct search_t{
+   Model *mp;
+   //columns sorted from the center to the sides
+   unsigned *order;
+   unsigned nbColumns;
+   unsigned nbCells;
+   unsigned long long nodes;
+   //NULL if the model doesn't have a transposition table
+   TranspositionTable *table;
+   //time (in seconds) when the search has to stop, 0 if there isn't any
+   double deadline;
+   int stopped;
+   /* flag stopping the search: the one of the model for the main thread, the
+    * one raised by the main thread for the helpers (NULL if there isn't any) */
+   int *sharedStop;
+}Search;
+
+/**
+ * @brief Implementation of a helper thread of the search (Lazy SMP)
+ *
+ * @remark Every helper searches the same position as the main thread, on its
+ * own copy of the model, with a slightly different order of the columns. They
+ * only communicate through the transposition table: the positions they store
+ * make the search of the main thread faster.
+ */
+typedef struct helper_t{
+   pthread_t thread;
+   Search s;
+   unsigned id;
+   //depth of the last iteration
+   unsigned maxDepth;
+}Helper;
+
+//_________DECLARATION OF THE STATIC FUNCTIONS_____________
+
+/**
+ * @brief Negamax with alpha-beta pruning and principal variation search
+ *
+ * @param s pointer on the search.
+ * @param depth number of moves left to look ahead.
+ * @param alpha lower bound of the score.
+ * @param beta upper bound of the score.
+ *
+ * @pre s != NULL, alpha < beta
+ * @post returns the score of the position for the colour whose turn it is
+ * (exact if it is between alpha and beta, a bound otherwise).
+ */
+static int negamax(Search *s, unsigned depth, int alpha, int beta);
+
+/**
+ * @brief Tells if the colour whose turn it is can win right now in a column
+ *
+ * @param mp pointer on the model.
+ * @param column index of the column.
+ * @param colour colour whose turn it is.
+ *
+ * @pre mp != NULL
+ * @post returns 1 if a token in the column wins the game, 0 otherwise.
+ */
+static int is_winning_column(Model *mp, unsigned column, Colour colour);
+
+/**
+ * @brief Prepares a search on a model
+ *
+ * @param s pointer on the search.
+ * @param mp pointer on the model.
+ *
+ * @pre s != NULL, mp != NULL
+ * @post the search is ready (to be freed with free(s->order)), without any
+ * helper.
+ *
+ * @return int 1 if the search is ready,
+ *         int -1 if an allocation failed.
+ */
+static int init_search(Search *s, Model *mp);
+
+/**
+ * @brief Searches every column of the current position at a given depth
+ *
+ * @param s pointer on the search.
+ * @param depth number of moves to look ahead.
+ * @param score a pointer that will store the score of the best column.
+ *
+ * @pre s != NULL, score != NULL, depth > 0
+ * @post returns the best column (-1 if the grid is full). If the search was
+ * stopped by its deadline, the column and the score must be ignored.
+ */
+static int search_root(Search *s, unsigned depth, int *score);
+
+/**
+ * @brief Starts the helper threads of a search (one less than the number of
+ *  threads of the model)
+ *
+ * @param mp pointer on the model.
+ * @param maxDepth depth of the last iteration of the helpers.
+ * @param stop flag that will stop the helpers.
+ * @param nbHelpers a pointer that will store the number of helpers started.
+ *
+ * @pre mp != NULL, stop != NULL, nbHelpers != NULL
+ * @post the helpers are running (to be stopped with stop_helpers). A helper
+ * that can't be created is skipped: the search just uses less threads.
+ *
+ * @return Helper* the array of the helpers (NULL if there isn't any).
+ */
+static Helper *start_helpers(Model *mp, unsigned maxDepth, int *stop,
+ unsigned *nbHelpers);
+
+/**
+ * @brief Stops the helper threads of a search and frees them
+ *
+ * @param helpers the array of the helpers.
+ * @param nbHelpers number of helpers.
+ * @param stop flag stopping the helpers.
+ *
+ * @pre stop != NULL
+ * @post the helpers are stopped and freed.
+ *
+ * @return unsigned long long the number of nodes searched by the helpers.
+ */
+static unsigned long long stop_helpers(Helper *helpers, unsigned nbHelpers,
+ int *stop);
+
+/**
+ * @brief Iterative deepening of a helper thread, until it is stopped
+ *
+ * @param data pointer on the helper.
+ *
+ * @pre data != NULL
+ * @post the helper is stopped.
+ */
+static void *run_helper(void *data);
+
+//________END OF THE DECLARATION__________________________
 
 // --------- Functions that check the angles -------------
 
-int verify_down(int range, Colour **grid, int* casesLeft, Colour colour,
+int verify_down(int range, const PackedGrid *grid, int* casesLeft, Colour colour,
  int i, const int NBLINES){
    assert(grid != NULL && casesLeft != NULL);
 
@@ -28,7 +178,7 @@ int verify_down(int range, Colour **grid, int* casesLeft, Colour colour,
 
    int isTrue = 1;
    for(int j = 1; j <= range && isTrue; ++j){
-      if(grid[casesLeft[i] + j][i] != colour){
+      if(get_packed_cell(grid, casesLeft[i] + j, i) != colour){
          //the sequence is broken up and therefore it becomes false
          isTrue = 0;
       }
@@ -42,7 +192,7 @@ int verify_down(int range, Colour **grid, int* casesLeft, Colour colour,
    }
 }
 
-int verify_right(int range, Colour **grid, int* casesLeft, Colour colour,
+int verify_right(int range, const PackedGrid *grid, int* casesLeft, Colour colour,
  int i, const int NBCOLUMNS){
    assert(grid != NULL && casesLeft != NULL);
 
@@ -53,7 +203,7 @@ int verify_right(int range, Colour **grid, int* casesLeft, Colour colour,
 
    int isTrue = 1;
    for(int j = 1; j <= range && isTrue; ++j){
-      if(grid[casesLeft[i]][i + j] != colour){
+      if(get_packed_cell(grid, casesLeft[i], i + j) != colour){
          //the sequence is broken up and therefore it becomes false
          isTrue = 0;
       }
@@ -67,7 +217,7 @@ int verify_right(int range, Colour **grid, int* casesLeft, Colour colour,
    }
 }
 
-int verify_left(int range, Colour **grid, int* casesLeft, Colour colour, int i){
+int verify_left(int range, const PackedGrid *grid, int* casesLeft, Colour colour, int i){
    assert(grid != NULL && casesLeft != NULL);
 
    //checking if the empty spot is not too close to the left
@@ -77,7 +227,7 @@ int verify_left(int range, Colour **grid, int* casesLeft, Colour colour, int i){
 
    int isTrue = 1;
    for(int j = 1; j <= range && isTrue; ++j){
-      if(grid[casesLeft[i]][i - j] != colour){
+      if(get_packed_cell(grid, casesLeft[i], i - j) != colour){
          //the sequence is broken up and therefore it becomes false
          isTrue = 0;
       }
@@ -91,7 +241,7 @@ int verify_left(int range, Colour **grid, int* casesLeft, Colour colour, int i){
    }
 }
 
-int verify_down_right(int range, Colour **grid, int* casesLeft, Colour colour,
+int verify_down_right(int range, const PackedGrid *grid, int* casesLeft, Colour colour,
  int i, const int NBLINES, const int NBCOLUMNS){
    assert(grid != NULL && casesLeft != NULL);
 
@@ -102,7 +252,7 @@ int verify_down_right(int range, Colour **grid, int* casesLeft, Colour colour,
 
    int isTrue = 1;
    for(int j = 1; j <= range && isTrue; ++j){
-      if(grid[casesLeft[i] + j][i + j] != colour){
+      if(get_packed_cell(grid, casesLeft[i] + j, i + j) != colour){
          //the sequence is broken up and therefore it becomes false
          isTrue = 0;
       }
@@ -116,7 +266,7 @@ int verify_down_right(int range, Colour **grid, int* casesLeft, Colour colour,
    }
 }
 
-int verify_down_left(int range, Colour **grid, int* casesLeft, Colour colour,
+int verify_down_left(int range, const PackedGrid *grid, int* casesLeft, Colour colour,
  int i, const int NBLINES){
    assert(grid != NULL && casesLeft != NULL);
 
@@ -127,7 +277,7 @@ int verify_down_left(int range, Colour **grid, int* casesLeft, Colour colour,
 
    int isTrue = 1;
    for(int j = 1; j <= range && isTrue; ++j){
-      if(grid[casesLeft[i] + j][i - j] != colour){
+      if(get_packed_cell(grid, casesLeft[i] + j, i - j) != colour){
          //the sequence is broken up and therefore it becomes false
          isTrue = 0;
       }
@@ -141,7 +291,7 @@ int verify_down_left(int range, Colour **grid, int* casesLeft, Colour colour,
    }
 }
 
-int verify_up_right(int range, Colour **grid, int* casesLeft, Colour colour,
+int verify_up_right(int range, const PackedGrid *grid, int* casesLeft, Colour colour,
  int i, const int NBCOLUMNS){
    assert(grid != NULL && casesLeft != NULL);
 
@@ -152,7 +302,7 @@ int verify_up_right(int range, Colour **grid, int* casesLeft, Colour colour,
 
    int isTrue = 1;
    for(int j = 1; j <= range && isTrue; ++j){
-      if(grid[casesLeft[i] - j][i + j] != colour){
+      if(get_packed_cell(grid, casesLeft[i] - j, i + j) != colour){
          //the sequence is broken up and therefore it becomes false
          isTrue = 0;
       }
@@ -166,7 +316,7 @@ int verify_up_right(int range, Colour **grid, int* casesLeft, Colour colour,
    }
 }
 
-int verify_up_left(int range, Colour **grid, int* casesLeft, Colour colour, int i){
+int verify_up_left(int range, const PackedGrid *grid, int* casesLeft, Colour colour, int i){
    assert(grid != NULL && casesLeft != NULL);
 
    //checking if the empty spot is not too close to the top left
@@ -176,7 +326,7 @@ int verify_up_left(int range, Colour **grid, int* casesLeft, Colour colour, int
 
    int isTrue = 1;
    for(int j = 1; j <= range && isTrue; ++j){
-      if(grid[casesLeft[i] - j][i - j] != colour){
+      if(get_packed_cell(grid, casesLeft[i] - j, i - j) != colour){
          //the sequence is broken up and therefore it becomes false
          isTrue = 0;
       }
@@ -192,7 +342,7 @@ int verify_up_left(int range, Colour **grid, int* casesLeft, Colour colour, int
 
 // -------------- Functions that check a token within others -----------
 
-int verify_within_row(int range, int i, Colour **grid, int* casesLeft, Colour colour,
+int verify_within_row(int range, int i, const PackedGrid *grid, int* casesLeft, Colour colour,
  const int NBCOLUMNS){
    assert(grid != NULL && casesLeft != NULL);
 
@@ -204,7 +354,8 @@ int verify_within_row(int range, int i, Colour **grid, int* casesLeft, Colour co
    int checkRight = i < (NBCOLUMNS - (range - 1));
 
    int isTrue = 0;
-   if(grid[casesLeft[i]][i - 1] == colour && grid[casesLeft[i]][i + 1] == colour){
+   if(get_packed_cell(grid, casesLeft[i], i - 1) == colour
+    && get_packed_cell(grid, casesLeft[i], i + 1) == colour){
       isTrue = 1;
    }
 
@@ -216,13 +367,13 @@ int verify_within_row(int range, int i, Colour **grid, int* casesLeft, Colour co
       if(range == 3){
          //if checkLeft true, then we are allowed to check further on the left
          if(checkLeft){
-            if(grid[casesLeft[i]][i - 2] == colour){
+            if(get_packed_cell(grid, casesLeft[i], i - 2) == colour){
                return i;
             }
          }
          //if checkRight true, then we are allowed to check further on the right
          if(checkRight){
-            if(grid[casesLeft[i]][i + 2] == colour){
+            if(get_packed_cell(grid, casesLeft[i], i + 2) == colour){
                return i;
             }
          }
@@ -233,7 +384,7 @@ int verify_within_row(int range, int i, Colour **grid, int* casesLeft, Colour co
    return -1;
 }
 
-int verify_within_diagonal_left(int range, int i, Colour **grid, int* casesLeft, Colour colour,
+int verify_within_diagonal_left(int range, int i, const PackedGrid *grid, int* casesLeft, Colour colour,
  const int NBLINES, const int NBCOLUMNS){
    assert(grid != NULL && casesLeft != NULL);
 
@@ -252,7 +403,8 @@ int verify_within_diagonal_left(int range, int i, Colour **grid, int* casesLeft,
    int checkBottom = casesLeft[i] < (NBLINES - (range - 1));
 
    int isTrue = 0;
-   if(grid[casesLeft[i] - 1][i - 1] == colour && grid[casesLeft[i] + 1][i + 1] == colour){
+   if(get_packed_cell(grid, casesLeft[i] - 1, i - 1) == colour
+    && get_packed_cell(grid, casesLeft[i] + 1, i + 1) == colour){
       isTrue = 1;
    }
    if(isTrue){
@@ -263,13 +415,13 @@ int verify_within_diagonal_left(int range, int i, Colour **grid, int* casesLeft,
       if(range == 3){
          //if true, then we are allowed to check further on the top left
          if(checkTop && checkLeft){
-            if(grid[casesLeft[i] - 2][i - 2] == colour){
+            if(get_packed_cell(grid, casesLeft[i] - 2, i - 2) == colour){
                return i;
             }
          }
          //if true, then we are allowed to check further on the bottom right
          if(checkBottom && checkRight){
-            if(grid[casesLeft[i] + 2][i + 2] == colour){
+            if(get_packed_cell(grid, casesLeft[i] + 2, i + 2) == colour){
                return i;
             }
          }
@@ -279,7 +431,7 @@ int verify_within_diagonal_left(int range, int i, Colour **grid, int* casesLeft,
    return -1;
 }
 
-int verify_within_diagonal_right(int range, int i, Colour **grid, int* casesLeft, Colour colour,
+int verify_within_diagonal_right(int range, int i, const PackedGrid *grid, int* casesLeft, Colour colour,
  const int NBLINES, const int NBCOLUMNS){
    assert(grid != NULL && casesLeft != NULL);
 
@@ -298,7 +450,8 @@ int verify_within_diagonal_right(int range, int i, Colour **grid, int* casesLeft
    int checkBottom = casesLeft[i] < (NBLINES - (range - 1));
 
    int isTrue = 0;
-   if(grid[casesLeft[i] + 1][i - 1] == colour && grid[casesLeft[i] - 1][i + 1] == colour){
+   if(get_packed_cell(grid, casesLeft[i] + 1, i - 1) == colour
+    && get_packed_cell(grid, casesLeft[i] - 1, i + 1) == colour){
       isTrue = 1;
    }
    if(isTrue){
@@ -309,13 +462,13 @@ int verify_within_diagonal_right(int range, int i, Colour **grid, int* casesLeft
       if(range == 3){
          //if it is true, then we are allowed to check farther down and left
          if(checkBottom && checkLeft){
-            if(grid[casesLeft[i] + 2][i - 2] == colour){
+            if(get_packed_cell(grid, casesLeft[i] + 2, i - 2) == colour){
                return i;
             }
          }
          //if it is true, then we are allowed to check farther up and right
          if(checkTop && checkRight){
-            if(grid[casesLeft[i] - 2][i + 2] == colour){
+            if(get_packed_cell(grid, casesLeft[i] - 2, i + 2) == colour){
                return i;
             }
          }
@@ -324,3 +477,579 @@ int verify_within_diagonal_right(int range, int i, Colour **grid, int* casesLeft
 
    return -1;
 }
+
+// -------------- Search of the game tree -----------
+
+unsigned get_default_depth(unsigned nbLines, unsigned nbColumns){
+   assert(nbLines > 0 && nbColumns > 0);
+
+   /* with a good ordering, alpha-beta visits about nbColumns^(depth/2)
+    * nodes: we take the deepest search that stays under the budget */
+   unsigned depth = 2;
+   unsigned long long nodes = nbColumns;
+   while(depth < nbLines * nbColumns && nodes * nbColumns <= NODES_BUDGET){
+      nodes *= nbColumns;
+      depth += 2;
+   }
+
+   return depth;
+}
+
+int search_best_column(Model *mp, unsigned depth, SearchInfo *info){
+   assert(mp != NULL && depth > 0);
+
+   int bookColumn = get_book_column(mp, info);
+   if(bookColumn != -1){
+      return bookColumn;
+   }
+
+   double start = get_time();
+
+   Search s;
+   if(init_search(&s, mp) == -1){
+      return -1;
+   }
+
+   //the copies searching at the same time leave the age to the owner
+   if(s.table != NULL && !is_copy(mp)){
+      new_search_table(s.table);
+   }
+
+   int stop = 0;
+   unsigned nbHelpers = 0;
+   Helper *helpers = start_helpers(mp, depth, &stop, &nbHelpers);
+
+   int score = 0;
+   int column = search_root(&s, depth, &score);
+
+   s.nodes += stop_helpers(helpers, nbHelpers, &stop);
+   free(s.order);
+
+   //an unfinished search doesn't give any column
+   if(s.stopped){
+      column = -1;
+   }
+
+   if(info != NULL){
+      info->column = column;
+      info->score = score;
+      info->depth = depth;
+      info->nodes = s.nodes;
+      info->seconds = get_time() - start;
+   }
+
+   return column;
+}
+
+int search_best_column_timed(Model *mp, unsigned milliseconds,
+ SearchInfo *info){
+   assert(mp != NULL);
+
+   //without any time, only the first iteration is done
+   return search_best_column_deepening(mp, milliseconds,
+    (milliseconds == 0) ? 1 : 0, NULL, NULL, info);
+}
+
+int search_best_column_deepening(Model *mp, unsigned milliseconds,
+ unsigned maxDepth, IterationReport report, void *data, SearchInfo *info){
+   assert(mp != NULL);
+
+   int bookColumn = get_book_column(mp, info);
+   if(bookColumn != -1){
+      return bookColumn;
+   }
+
+   double start = get_time();
+
+   Search s;
+   if(init_search(&s, mp) == -1){
+      return -1;
+   }
+
+   //the copies searching at the same time leave the age to the owner
+   if(s.table != NULL && !is_copy(mp)){
+      new_search_table(s.table);
+   }
+
+   const unsigned CELLSLEFT = s.nbCells - get_nb_moves(mp);
+   if(maxDepth == 0 || maxDepth > CELLSLEFT){
+      maxDepth = CELLSLEFT;
+   }
+   int stop = 0;
+   unsigned nbHelpers = 0;
+   Helper *helpers = start_helpers(mp, maxDepth, &stop, &nbHelpers);
+
+   int column = -1;
+   int score = 0;
+   unsigned depth = 0;
+
+   /* the first iteration always ends (only a cancellation can stop it), so
+    * that there is always a column to play */
+   for(unsigned d = 1; d <= maxDepth; ++d){
+      int iterationScore;
+      int iterationColumn = search_root(&s, d, &iterationScore);
+      if(s.stopped){
+         break;
+      }
+
+      column = iterationColumn;
+      score = iterationScore;
+      depth = d;
+
+      if(report != NULL && column != -1){
+         SearchInfo iteration;
+         iteration.column = column;
+         iteration.score = score;
+         iteration.depth = depth;
+         iteration.nodes = s.nodes;
+         iteration.seconds = get_time() - start;
+         report(&iteration, data);
+      }
+
+      //a win or a loss found won't change with a deeper search
+      if(score >= SCORE_WIN || score <= -SCORE_WIN || column == -1){
+         break;
+      }
+
+      if(milliseconds > 0){
+         s.deadline = start + milliseconds / 1000.0;
+         if(get_time() >= s.deadline){
+            break;
+         }
+      }
+   }
+
+   s.nodes += stop_helpers(helpers, nbHelpers, &stop);
+   free(s.order);
+
+   if(info != NULL){
+      info->column = column;
+      info->score = score;
+      info->depth = depth;
+      info->nodes = s.nodes;
+      info->seconds = get_time() - start;
+   }
+
+   return column;
+}
+
+unsigned get_principal_variation(Model *mp, unsigned *columns,
+ unsigned maxLength){
+   assert(mp != NULL && columns != NULL);
+
+   TranspositionTable *table = get_table(mp);
+   if(table == NULL){
+      return 0;
+   }
+
+   //the best columns stored in the table are played one after the other
+   unsigned length = 0;
+   int over = 0;
+   while(length < maxLength && !over){
+      int score;
+      unsigned depth;
+      Bound bound;
+      int column;
+      if(!probe_entry(table, get_hash(mp), &score, &depth, &bound, &column)
+       || column < 0 || column >= (int)get_nbColumns(mp)
+       || check_height(mp, (unsigned)column)){
+         break;
+      }
+
+      unsigned row = make_move(mp, (unsigned)column);
+      columns[length++] = (unsigned)column;
+      over = check_alignment(mp, row, (unsigned)column)
+       || get_nb_moves(mp) == get_nbLines(mp) * get_nbColumns(mp);
+   }
+
+   for(unsigned i = length; i > 0; --i){
+      unmake_move(mp, columns[i - 1]);
+   }
+
+   return length;
+}
+
+int get_book_column(Model *mp, SearchInfo *info){
+   assert(mp != NULL);
+
+   OpeningBook *book = get_book(mp);
+   if(book == NULL){
+      return -1;
+   }
+
+   int mirrored;
+   int column;
+   int score;
+   if(!probe_book(book, get_book_key(mp, &mirrored), &column, &score)){
+      return -1;
+   }
+
+   const int NBCOLUMNS = (int)get_nbColumns(mp);
+   if(mirrored){
+      column = NBCOLUMNS - 1 - column;
+   }
+   if(column < 0 || column >= NBCOLUMNS || check_height(mp, column)){
+      return -1;
+   }
+
+   if(info != NULL){
+      info->column = column;
+      info->score = score;
+      info->depth = 0;
+      info->nodes = 0;
+      info->seconds = 0;
+   }
+
+   return column;
+}
+
+// ----------- STATIC FUNCTIONS --------------------
+
+static int negamax(Search *s, unsigned depth, int alpha, int beta){
+   assert(s != NULL && alpha < beta);
+
+   Model *mp = s->mp;
+   const unsigned NBMOVES = get_nb_moves(mp);
+   ++s->nodes;
+
+   //the result of a stopped search doesn't matter anymore
+   if((s->nodes & (CHECK_NODES - 1)) == 0){
+      if(s->deadline > 0 && get_time() >= s->deadline){
+         s->stopped = 1;
+      }
+      if(s->sharedStop != NULL
+       && __atomic_load_n(s->sharedStop, __ATOMIC_RELAXED)){
+         s->stopped = 1;
+      }
+   }
+   if(s->stopped){
+      return 0;
+   }
+
+   //the grid is full: draw
+   if(NBMOVES == s->nbCells){
+      return 0;
+   }
+
+   Colour colour = get_side_to_move(mp);
+   Colour opponent = (colour == red) ? yellow : red;
+
+   //winning right now is always the best move
+   for(unsigned i = 0; i < s->nbColumns; ++i){
+      if(is_winning_column(mp, i, colour)){
+         return SCORE_WIN + (int)(s->nbCells - NBMOVES - 1);
+      }
+   }
+
+   //the windows still open tell which colour is better placed
+   if(depth == 0){
+      int score = evaluate_windows(mp, colour);
+      if(score > MAX_EVALUATION){
+         return MAX_EVALUATION;
+      }
+      if(score < -MAX_EVALUATION){
+         return -MAX_EVALUATION;
+      }
+      return score;
+   }
+
+   //if the opponent threatens to win, the only move left is to block them
+   int forced = -1;
+   for(unsigned i = 0; i < s->nbColumns; ++i){
+      if(is_winning_column(mp, i, opponent)){
+         if(forced != -1){
+            //two threats can't be blocked at once
+            return -(SCORE_WIN + (int)(s->nbCells - NBMOVES - 2));
+         }
+         forced = (int)i;
+      }
+   }
+
+   //we can't win before our next move at best
+   int max = SCORE_WIN + (int)s->nbCells - (int)NBMOVES - 3;
+   if(beta > max){
+      beta = max;
+      if(alpha >= beta){
+         return beta;
+      }
+   }
+
+   //a position already searched deep enough may give the score right away
+   const uint64_t HASH = get_hash(mp);
+   int ttColumn = -1;
+   if(s->table != NULL){
+      int ttScore;
+      unsigned ttDepth;
+      Bound ttBound;
+      if(probe_entry(s->table, HASH, &ttScore, &ttDepth, &ttBound, &ttColumn)
+       && ttDepth >= depth){
+         if(ttBound == exact){
+            return ttScore;
+         }
+         if(ttBound == lowerBound && ttScore > alpha){
+            alpha = ttScore;
+         }
+         else if(ttBound == upperBound && ttScore < beta){
+            beta = ttScore;
+         }
+         if(alpha >= beta){
+            return ttScore;
+         }
+      }
+   }
+
+   const int ALPHA = alpha;
+   int best = -2 * SCORE_WIN;
+   int bestColumn = -1;
+
+   //the best column stored in the table is tried first
+   for(int i = -1; i < (int)s->nbColumns && alpha < beta; ++i){
+      int column = (i == -1) ? ttColumn : (int)s->order[i];
+      if(column < 0 || (i >= 0 && column == ttColumn)
+       || check_height(mp, column) || (forced != -1 && column != forced)){
+         continue;
+      }
+
+      int score;
+      make_move(mp, column);
+      if(bestColumn == -1){
+         score = -negamax(s, depth - 1, -beta, -alpha);
+      }
+      else{
+         score = -negamax(s, depth - 1, -alpha - 1, -alpha);
+         if(score > alpha && score < beta){
+            score = -negamax(s, depth - 1, -beta, -alpha);
+         }
+      }
+      unmake_move(mp, column);
+
+      if(s->stopped){
+         return 0;
+      }
+
+      if(score > best){
+         best = score;
+         bestColumn = column;
+      }
+      if(score > alpha){
+         alpha = score;
+      }
+   }
+
+   if(s->table != NULL){
+      Bound bound = exact;
+      if(best <= ALPHA){
+         bound = upperBound;
+      }
+      else if(best >= beta){
+         bound = lowerBound;
+      }
+      store_entry(s->table, HASH, best, depth, bound, bestColumn);
+   }
+
+   return best;
+}
+
+static int is_winning_column(Model *mp, unsigned column, Colour colour){
+   assert(mp != NULL);
+
+   return check_grid(mp, 3, colour, (int)column) != -1;
+}
+
+static int init_search(Search *s, Model *mp){
+   assert(s != NULL && mp != NULL);
+
+   s->mp = mp;
+   s->nbColumns = get_nbColumns(mp);
+   s->nbCells = get_nbLines(mp) * s->nbColumns;
+   s->nodes = 0;
+   s->table = get_table(mp);
+   s->deadline = 0;
+   s->stopped = 0;
+   s->sharedStop = get_stop_flag(mp);
+   s->order = malloc(sizeof(unsigned) * s->nbColumns);
+   if(s->order == NULL){
+      return -1;
+   }
+
+   //the columns in the center take part in more alignments
+   int left = (int)(s->nbColumns - 1) / 2;
+   int right = left + 1;
+   for(unsigned i = 0; i < s->nbColumns; ++i){
+      if(left >= 0 && (i % 2 == 0 || right >= (int)s->nbColumns)){
+         s->order[i] = (unsigned)left--;
+      }
+      else{
+         s->order[i] = (unsigned)right++;
+      }
+   }
+
+   //then the columns whose token makes (or prevents) the most alignments
+   int *scores = malloc(sizeof(int) * s->nbColumns);
+   if(scores != NULL){
+      evaluate_columns(mp, scores);
+      for(unsigned i = 1; i < s->nbColumns; ++i){
+         unsigned column = s->order[i];
+         unsigned j = i;
+         while(j > 0 && scores[s->order[j - 1]] < scores[column]){
+            s->order[j] = s->order[j - 1];
+            --j;
+         }
+         s->order[j] = column;
+      }
+      free(scores);
+   }
+
+   return 1;
+}
+
+static int search_root(Search *s, unsigned depth, int *score){
+   assert(s != NULL && score != NULL && depth > 0);
+
+   Model *mp = s->mp;
+
+   //the best column of a previous search (or iteration) is tried first
+   int ttColumn = -1;
+   if(s->table != NULL){
+      int ttScore;
+      unsigned ttDepth;
+      Bound ttBound;
+      probe_entry(s->table, get_hash(mp), &ttScore, &ttDepth, &ttBound,
+       &ttColumn);
+   }
+
+   Colour colour = get_side_to_move(mp);
+   int bestColumn = -1;
+   int bestScore = -2 * SCORE_WIN;
+   int alpha = -2 * SCORE_WIN;
+   const int BETA = 2 * SCORE_WIN;
+
+   for(int i = -1; i < (int)s->nbColumns && !s->stopped; ++i){
+      int column = (i == -1) ? ttColumn : (int)s->order[i];
+      if(column < 0 || (i >= 0 && column == ttColumn)
+       || check_height(mp, column)){
+         continue;
+      }
+
+      int score;
+      if(is_winning_column(mp, column, colour)){
+         ++s->nodes;
+         score = SCORE_WIN + (int)(s->nbCells - get_nb_moves(mp) - 1);
+      }
+      else{
+         make_move(mp, column);
+         if(bestColumn == -1){
+            score = -negamax(s, depth - 1, -BETA, -alpha);
+         }
+         else{
+            //null window: we only want to know if this column is better
+            score = -negamax(s, depth - 1, -alpha - 1, -alpha);
+            if(score > alpha){
+               score = -negamax(s, depth - 1, -BETA, -alpha);
+            }
+         }
+         unmake_move(mp, column);
+      }
+
+      if(s->stopped){
+         break;
+      }
+
+      if(score > bestScore){
+         bestScore = score;
+         bestColumn = column;
+      }
+      if(score > alpha){
+         alpha = score;
+      }
+   }
+
+   if(s->table != NULL && bestColumn != -1 && !s->stopped){
+      store_entry(s->table, get_hash(mp), bestScore, depth, exact, bestColumn);
+   }
+
+   *score = bestScore;
+   return bestColumn;
+}
+
+static Helper *start_helpers(Model *mp, unsigned maxDepth, int *stop,
+ unsigned *nbHelpers){
+   assert(mp != NULL && stop != NULL && nbHelpers != NULL);
+
+   *nbHelpers = 0;
+   const unsigned NBHELPERS = get_nb_threads(mp) - 1;
+   if(NBHELPERS == 0 || maxDepth == 0){
+      return NULL;
+   }
+
+   Helper *helpers = malloc(sizeof(Helper) * NBHELPERS);
+   if(helpers == NULL){
+      return NULL;
+   }
+
+   for(unsigned i = 0; i < NBHELPERS; ++i){
+      Helper *h = &helpers[*nbHelpers];
+      Model *copy = duplicate_model(mp);
+      if(copy == NULL){
+         break;
+      }
+      if(init_search(&h->s, copy) == -1){
+         free_model(copy);
+         break;
+      }
+
+      h->id = i + 1;
+      h->maxDepth = maxDepth;
+      h->s.sharedStop = stop;
+
+      //another column is tried first, so that the threads don't all agree
+      unsigned swapped = h->id % h->s.nbColumns;
+      unsigned first = h->s.order[0];
+      h->s.order[0] = h->s.order[swapped];
+      h->s.order[swapped] = first;
+
+      if(pthread_create(&h->thread, NULL, run_helper, h)){
+         free(h->s.order);
+         free_model(copy);
+         break;
+      }
+      ++*nbHelpers;
+   }
+
+   return helpers;
+}
+
+static unsigned long long stop_helpers(Helper *helpers, unsigned nbHelpers,
+ int *stop){
+   assert(stop != NULL);
+
+   __atomic_store_n(stop, 1, __ATOMIC_RELAXED);
+
+   unsigned long long nodes = 0;
+   for(unsigned i = 0; i < nbHelpers; ++i){
+      pthread_join(helpers[i].thread, NULL);
+      nodes += helpers[i].s.nodes;
+      free(helpers[i].s.order);
+      free_model(helpers[i].s.mp);
+   }
+   free(helpers);
+
+   return nodes;
+}
+
+static void *run_helper(void *data){
+   assert(data != NULL);
+
+   Helper *h = data;
+
+   //half of the helpers start one ply deeper than the main thread
+   for(unsigned d = 1 + h->id % 2; d <= h->maxDepth && !h->s.stopped; ++d){
+      int score;
+      search_root(&h->s, d, &score);
+      if(score >= SCORE_WIN || score <= -SCORE_WIN){
+         break;
+      }
+   }
+
+   return NULL;
+}
@@ -20,6 +20,23 @@
 
 #include "model.h"
 
+/**
+ * @brief Score of a win for the side to move, increased by the number of
+ * cells left empty after the winning move (the faster, the better)
+ */
+#define SCORE_WIN 1000000
+
+/**
+ * @brief Implementation of the information about a search of the game tree
+ */
+struct search_info_t{
+   int column;
+   int score;
+   unsigned depth;
+   unsigned long long nodes;
+   double seconds;
+};
+
 /**
  * @brief Checks in a grid if there is a sequence of elements
  *  underneath a "blank" spot.
@@ -41,7 +58,7 @@
  * @return int i if a sequence has been found,
  *         int -1 if a sequence hasn't been found.
  */
-int verify_down(int range, Colour **grid, int* casesLeft, Colour colour,
+int verify_down(int range, const PackedGrid *grid, int* casesLeft, Colour colour,
  int i, const int NBLINES);
 
 /**
@@ -65,7 +82,7 @@ int verify_down(int range, Colour **grid, int* casesLeft, Colour colour,
  * @return int i if a sequence has been found,
  *         int -1 if a sequence hasn't been found.
  */
-int verify_right(int range, Colour **grid, int* casesLeft, Colour colour,
+int verify_right(int range, const PackedGrid *grid, int* casesLeft, Colour colour,
  int i, const int NBCOLUMNS);
 
 /**
@@ -88,7 +105,7 @@ int verify_right(int range, Colour **grid, int* casesLeft, Colour colour,
  * @return int i if a sequence has been found,
  *         int -1 if a sequence hasn't been found.
  */
-int verify_left(int range, Colour **grid, int* casesLeft, Colour colour, int i);
+int verify_left(int range, const PackedGrid *grid, int* casesLeft, Colour colour, int i);
 
 /**
  * @brief Checks in a grid if there is a sequence of elements in a diagonal
@@ -111,7 +128,7 @@ int verify_left(int range, Colour **grid, int* casesLeft, Colour colour, int i);
  * @return int i if a sequence has been found,
  *         int -1 if a sequence hasn't been found.
  */
-int verify_down_right(int range, Colour **grid, int* casesLeft, Colour colour,
+int verify_down_right(int range, const PackedGrid *grid, int* casesLeft, Colour colour,
  int i, const int NBLINES, const int NBCOLUMNS);
 
 /**
@@ -134,7 +151,7 @@ int verify_down_right(int range, Colour **grid, int* casesLeft, Colour colour,
  * @return int i if a sequence has been found,
  *         int -1 if a sequence hasn't been found.
  */
-int verify_down_left(int range, Colour **grid, int* casesLeft, Colour colour,
+int verify_down_left(int range, const PackedGrid *grid, int* casesLeft, Colour colour,
  int i, const int NBLINES);
 
 /**
@@ -157,7 +174,7 @@ int verify_down_left(int range, Colour **grid, int* casesLeft, Colour colour,
  * @return int i if a sequence has been found,
  *         int -1 if a sequence hasn't been found.
  */
-int verify_up_right(int range, Colour **grid, int* casesLeft, Colour colour,
+int verify_up_right(int range, const PackedGrid *grid, int* casesLeft, Colour colour,
  int i, const int NBCOLUMNS);
 
 /**
@@ -179,7 +196,7 @@ int verify_up_right(int range, Colour **grid, int* casesLeft, Colour colour,
  * @return int i if a sequence has been found,
  *         int -1 if a sequence hasn't been found.
  */
-int verify_up_left(int range, Colour **grid, int* casesLeft, Colour colour, int i);
+int verify_up_left(int range, const PackedGrid *grid, int* casesLeft, Colour colour, int i);
 
 /**
  * @brief Checks in a grid if an element forms a sequence with the elements
@@ -202,7 +219,7 @@ int verify_up_left(int range, Colour **grid, int* casesLeft, Colour colour, int
  * @return int i if a sequence has been found,
  *         int -1 if a sequence hasn't been found.
  */
-int verify_within_row(int range, int i, Colour **grid, int* casesLeft, Colour colour,
+int verify_within_row(int range, int i, const PackedGrid *grid, int* casesLeft, Colour colour,
  const int NBCOLUMNS);
 
 /**
@@ -227,7 +244,7 @@ int verify_within_row(int range, int i, Colour **grid, int* casesLeft, Colour co
  * @return int i if a sequence has been found,
  *         int -1 if a sequence hasn't been found.
  */
-int verify_within_diagonal_left(int range, int i, Colour **grid, int* casesLeft, Colour colour,
+int verify_within_diagonal_left(int range, int i, const PackedGrid *grid, int* casesLeft, Colour colour,
  const int NBLINES, const int NBCOLUMNS);
 
 /**
@@ -252,7 +269,140 @@ int verify_within_diagonal_left(int range, int i, Colour **grid, int* casesLeft,
  * @return int i if a sequence has been found,
  *         int -1 if a sequence hasn't been found.
  */
-int verify_within_diagonal_right(int range, int i, Colour **grid, int* casesLeft, Colour colour,
+int verify_within_diagonal_right(int range, int i, const PackedGrid *grid, int* casesLeft, Colour colour,
  const int NBLINES, const int NBCOLUMNS);
 
+// -------------- Search of the game tree -----------
+
+/**
+ * @brief Gives the depth of the search for a grid, so that the computer
+ *  still answers quickly on the large grids
+ *
+ * @param nbLines number of lines of the grid.
+ * @param nbColumns number of columns of the grid.
+ *
+ * @pre nbLines > 0, nbColumns > 0
+ * @post returns the number of moves the search looks ahead.
+ */
+unsigned get_default_depth(unsigned nbLines, unsigned nbColumns);
+
+/**
+ * @brief Searches the best column for the colour whose turn it is, with a
+ *  negamax with alpha-beta pruning and principal variation search
+ *
+ * @remark The moves are made and unmade on the model itself: it is in the same
+ * state after the search as before. The positions at the end of the search
+ * are given the score of evaluate_windows(), far below SCORE_WIN.
+ *
+ * @param mp pointer on the model.
+ * @param depth number of moves the search looks ahead.
+ * @param info a pointer that will store the information about the search
+ * (can be NULL).
+ *
+ * @pre mp != NULL, depth > 0
+ * @post returns the index of the best column found, -1 if the grid is full or
+ * if the search was stopped by the flag of the model (see set_stop_flag()).
+ *
+ * @return int index of the column,
+ *         int -1 if there is no column left or the search was stopped.
+ */
+int search_best_column(Model *mp, unsigned depth, SearchInfo *info);
+
+/**
+ * @brief Searches the best column for the colour whose turn it is, one move
+ *  deeper at a time, until a deadline
+ *
+ * @remark When the time is up, the search in progress is stopped and the
+ * column found by the last complete iteration is returned. The first
+ * iteration (one move ahead) is always complete, unless the search is
+ * stopped by the flag of the model (see set_stop_flag()).
+ *
+ * @param mp pointer on the model.
+ * @param milliseconds time the search may take.
+ * @param info a pointer that will store the information about the search
+ * (can be NULL), the depth being the one of the last complete iteration.
+ *
+ * @pre mp != NULL
+ * @post returns the index of the best column found, -1 if the grid is full or
+ * if the search was stopped before the end of its first iteration.
+ *
+ * @return int index of the column,
+ *         int -1 if there is no column left or the search was stopped.
+ */
+int search_best_column_timed(Model *mp, unsigned milliseconds,
+ SearchInfo *info);
+
+/**
+ * @brief Function told about each iteration of a search (see
+ *  search_best_column_deepening())
+ *
+ * @param info the column, score and depth of the iteration, with the nodes
+ * and time of the search so far.
+ * @param data the pointer given to the search.
+ */
+typedef void (*IterationReport)(const SearchInfo *info, void *data);
+
+/**
+ * @brief Searches the best column for the colour whose turn it is, one move
+ *  deeper at a time, until a deadline, a depth or the flag of the model
+ *
+ * @remark search_best_column_timed() is this search without any depth. The
+ * report is called by the thread of the search at the end of each iteration,
+ * when the model is back in its position (it can look into the table, see
+ * get_principal_variation()).
+ *
+ * @param mp pointer on the model.
+ * @param milliseconds time the search may take (0: no deadline).
+ * @param maxDepth depth of the last iteration (0: until the grid is full).
+ * @param report function told about each complete iteration (can be NULL).
+ * @param data pointer given to the report.
+ * @param info a pointer that will store the information about the search
+ * (can be NULL), the depth being the one of the last complete iteration.
+ *
+ * @pre mp != NULL
+ * @post returns the index of the best column found, -1 if the grid is full or
+ * if the search was stopped before the end of its first iteration.
+ *
+ * @return int index of the column,
+ *         int -1 if there is no column left or the search was stopped.
+ */
+int search_best_column_deepening(Model *mp, unsigned milliseconds,
+ unsigned maxDepth, IterationReport report, void *data, SearchInfo *info);
+
+/**
+ * @brief Gives the moves the search expects from the current position
+ *
+ * @remark The best columns stored in the transposition table are followed
+ * until a position isn't in it anymore or the game is over.
+ *
+ * @param mp pointer on the model.
+ * @param columns array that will store the columns.
+ * @param maxLength size of the array.
+ *
+ * @pre mp != NULL, columns != NULL
+ * @post returns the number of columns stored (0 if the model has no table),
+ * the model is in the same position as before.
+ */
+unsigned get_principal_variation(Model *mp, unsigned *columns,
+ unsigned maxLength);
+
+/**
+ * @brief Looks for the current position in the opening book of the model
+ *
+ * @remark Every search starts with it: the positions of the book don't need
+ * any search.
+ *
+ * @param mp pointer on the model.
+ * @param info a pointer that will store the information about the move found
+ * (can be NULL).
+ *
+ * @pre mp != NULL
+ * @post returns the column of the book (in the grid of the model), -1 if the
+ * model has no book or the position isn't in it.
+ *
+ * @return int index of the column,
+ *         int -1 if the book doesn't know the position.
+ */
+int get_book_column(Model *mp, SearchInfo *info);
+
 #endif //__AI__
\ No newline at end of file
@@ -0,0 +1,232 @@
+/**
+ * @file bitboard.c
+ *
+ * @author Alyssia Kayembe S211023 & Jiaxiang Yao S214174
+ *
+ * @brief File implementing the functions handling the bitboards used by the
+ *  Model of a Connect 4
+ *
+ * @date 18-10-26
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "bitboard.h"
+
+#define WORD_BITS 64
+
+//_________DECLARATION OF THE STATIC FUNCTIONS____________
+
+/**
+ * @brief Computes the word i of a bitboard shifted to the left
+ *
+ * @param bb the bitboard.
+ * @param nbWords number of words of the bitboard.
+ * @param i index of the word wanted.
+ * @param shift number of bits of the shift.
+ *
+ * @pre bb != NULL
+ * @post returns the word i of (bb << shift), the bits going out of the
+ * bitboard are lost.
+ */
+static uint64_t shift_left_word(const uint64_t *bb, unsigned nbWords,
+ unsigned i, unsigned shift);
+
+/**
+ * @brief Computes the word i of a bitboard shifted to the right
+ *
+ * @param bb the bitboard.
+ * @param nbWords number of words of the bitboard.
+ * @param i index of the word wanted.
+ * @param shift number of bits of the shift.
+ *
+ * @pre bb != NULL
+ * @post returns the word i of (bb >> shift).
+ */
+static uint64_t shift_right_word(const uint64_t *bb, unsigned nbWords,
+ unsigned i, unsigned shift);
+
+/**
+ * @brief Computes the word i of (bb & (bb >> shift)), the mask of the
+ *  tokens followed by another one in the direction given by the shift
+ *
+ * @param bb the bitboard.
+ * @param nbWords number of words of the bitboard.
+ * @param i index of the word wanted.
+ * @param shift number of bits of the shift.
+ *
+ * @pre bb != NULL
+ * @post returns the word i of the mask (0 if i is out of the bitboard).
+ */
+static uint64_t pair_word(const uint64_t *bb, unsigned nbWords, unsigned i,
+ unsigned shift);
+
+//________END OF THE DECLARATION__________________________
+
+unsigned get_nb_words(unsigned nbLines, unsigned nbColumns){
+   assert(nbLines > 0 && nbColumns > 0);
+
+   unsigned nbBits = (nbLines + 1) * nbColumns;
+   return (nbBits + WORD_BITS - 1) / WORD_BITS;
+}
+
+unsigned get_bit_index(unsigned nbLines, unsigned row, unsigned column){
+   assert(row < nbLines);
+
+   return column * (nbLines + 1) + (nbLines - 1 - row);
+}
+
+void clear_bitboard(uint64_t *bb, unsigned nbWords){
+   assert(bb != NULL);
+
+   memset(bb, 0, sizeof(uint64_t) * nbWords);
+}
+
+void fill_board_mask(uint64_t *bb, unsigned nbWords, unsigned nbLines,
+ unsigned nbColumns){
+   assert(bb != NULL);
+
+   clear_bitboard(bb, nbWords);
+   for(unsigned j = 0; j < nbColumns; ++j){
+      for(unsigned i = 0; i < nbLines; ++i){
+         set_bit(bb, get_bit_index(nbLines, i, j));
+      }
+   }
+}
+
+int has_alignment(const uint64_t *bb, unsigned nbWords, unsigned nbLines){
+   assert(bb != NULL);
+
+   //vertical, horizontal and the two diagonals
+   const unsigned SHIFTS[4] = {1, nbLines + 1, nbLines, nbLines + 2};
+
+   for(unsigned d = 0; d < 4; ++d){
+      //two tokens followed by two others, two cells further
+      unsigned q = (2 * SHIFTS[d]) / WORD_BITS;
+      unsigned r = (2 * SHIFTS[d]) % WORD_BITS;
+
+      for(unsigned i = 0; i < nbWords; ++i){
+         uint64_t further = pair_word(bb, nbWords, i + q, SHIFTS[d]) >> r;
+         if(r){
+            further |= pair_word(bb, nbWords, i + q + 1, SHIFTS[d])
+             << (WORD_BITS - r);
+         }
+
+         if(pair_word(bb, nbWords, i, SHIFTS[d]) & further){
+            return 1;
+         }
+      }
+   }
+
+   return 0;
+}
+
+int aligns_four(const uint64_t *bb, unsigned nbLines, unsigned nbColumns,
+ unsigned index){
+   assert(bb != NULL);
+
+   //vertical, horizontal and the two diagonals
+   const unsigned SHIFTS[4] = {1, nbLines + 1, nbLines, nbLines + 2};
+   //the extra bits stop the lines at the edges, except before/after the grid
+   const unsigned NBBITS = (nbLines + 1) * nbColumns;
+
+   for(unsigned d = 0; d < 4; ++d){
+      const unsigned S = SHIFTS[d];
+      unsigned count = 0;
+
+      //tokens before the cell
+      for(unsigned k = 1; k <= 3 && index >= k * S
+       && test_bit(bb, index - k * S); ++k){
+         ++count;
+      }
+
+      //tokens after the cell
+      for(unsigned k = 1; k <= 3 && index + k * S < NBBITS
+       && test_bit(bb, index + k * S); ++k){
+         ++count;
+      }
+
+      if(count >= 3){
+         return 1;
+      }
+   }
+
+   return 0;
+}
+
+uint64_t winning_cells_word(const uint64_t *bb, unsigned nbWords,
+ unsigned nbLines, unsigned i){
+   assert(bb != NULL && i < nbWords);
+
+   //vertically, only the three tokens underneath matter
+   uint64_t cells = shift_left_word(bb, nbWords, i, 1)
+    & shift_left_word(bb, nbWords, i, 2) & shift_left_word(bb, nbWords, i, 3);
+
+   //horizontal and the two diagonals
+   const unsigned SHIFTS[3] = {nbLines + 1, nbLines, nbLines + 2};
+
+   for(unsigned d = 0; d < 3; ++d){
+      const unsigned S = SHIFTS[d];
+      uint64_t before = shift_left_word(bb, nbWords, i, S);
+      uint64_t after = shift_right_word(bb, nbWords, i, S);
+
+      //two tokens on one side, the third one further or on the other side
+      uint64_t pair = before & shift_left_word(bb, nbWords, i, 2 * S);
+      cells |= pair & shift_left_word(bb, nbWords, i, 3 * S);
+      cells |= pair & after;
+
+      pair = after & shift_right_word(bb, nbWords, i, 2 * S);
+      cells |= pair & before;
+      cells |= pair & shift_right_word(bb, nbWords, i, 3 * S);
+   }
+
+   return cells;
+}
+
+// ----------- STATIC FUNCTIONS --------------------
+
+static uint64_t shift_left_word(const uint64_t *bb, unsigned nbWords,
+ unsigned i, unsigned shift){
+   assert(bb != NULL);
+
+   unsigned q = shift / WORD_BITS;
+   unsigned r = shift % WORD_BITS;
+
+   if(i < q || i >= nbWords){
+      return 0;
+   }
+
+   uint64_t word = bb[i - q] << r;
+   if(r && i > q){
+      word |= bb[i - q - 1] >> (WORD_BITS - r);
+   }
+   return word;
+}
+
+static uint64_t shift_right_word(const uint64_t *bb, unsigned nbWords,
+ unsigned i, unsigned shift){
+   assert(bb != NULL);
+
+   unsigned q = shift / WORD_BITS;
+   unsigned r = shift % WORD_BITS;
+
+   if(i + q >= nbWords){
+      return 0;
+   }
+
+   uint64_t word = bb[i + q] >> r;
+   if(r && i + q + 1 < nbWords){
+      word |= bb[i + q + 1] << (WORD_BITS - r);
+   }
+   return word;
+}
+
+static uint64_t pair_word(const uint64_t *bb, unsigned nbWords, unsigned i,
+ unsigned shift){
+   if(i >= nbWords){
+      return 0;
+   }
+   return bb[i] & shift_right_word(bb, nbWords, i, shift);
+}
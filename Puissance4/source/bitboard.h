@@ -0,0 +1,170 @@
+/**
+ * @file bitboard.h
+ *
+ * @author Alyssia Kayembe S211023 & Jiaxiang Yao S214174
+ *
+ * @brief Header of the file containing the functions handling the bitboards
+ *  used by the Model of a Connect 4
+ *
+ * @remark A bitboard is an array of 64 bits words where every cell of the grid
+ * is represented by one bit. The grid is stored column by column, from the
+ * bottom to the top, and each column has one more bit (always 0) above its
+ * highest cell. This extra bit prevents the alignments from "wrapping" from a
+ * column to the next one, whatever the size of the grid is.
+ * The bit of the cell (row, column), where row 0 is the top of the grid, is
+ * therefore column * (nbLines + 1) + (nbLines - 1 - row).
+ *
+ * @date 18-10-26
+ */
+
+#ifndef ___BITBOARD___
+#define ___BITBOARD___
+
+#include <stdint.h>
+
+/**
+ * @brief Defined when the vector kernels of the playouts and of the
+ *  evaluation can be compiled (x86 processors, GCC or Clang)
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VECTOR_X86
+#endif
+
+/**
+ * @brief Gives the number of 64 bits words needed to store a grid
+ *
+ * @param nbLines number of lines of the grid.
+ * @param nbColumns number of columns of the grid.
+ *
+ * @pre nbLines > 0, nbColumns > 0
+ * @post returns the number of words of a bitboard of that size.
+ */
+unsigned get_nb_words(unsigned nbLines, unsigned nbColumns);
+
+/**
+ * @brief Gives the index of the bit representing a cell of the grid
+ *
+ * @param nbLines number of lines of the grid.
+ * @param row index of the line of the cell (0 is the top of the grid).
+ * @param column index of the column of the cell.
+ *
+ * @pre row < nbLines
+ * @post returns the index of the bit of that cell.
+ */
+unsigned get_bit_index(unsigned nbLines, unsigned row, unsigned column);
+
+/**
+ * @brief Sets every bit of a bitboard to 0
+ *
+ * @param bb the bitboard.
+ * @param nbWords number of words of the bitboard.
+ *
+ * @pre bb != NULL
+ * @post the bitboard is empty.
+ */
+void clear_bitboard(uint64_t *bb, unsigned nbWords);
+
+/**
+ * @brief Fills a bitboard with every cell of a grid (extra bits excluded)
+ *
+ * @param bb the bitboard.
+ * @param nbWords number of words of the bitboard.
+ * @param nbLines number of lines of the grid.
+ * @param nbColumns number of columns of the grid.
+ *
+ * @pre bb != NULL
+ * @post the bits of all the cells of the grid are set to 1, the others to 0.
+ */
+void fill_board_mask(uint64_t *bb, unsigned nbWords, unsigned nbLines,
+ unsigned nbColumns);
+
+/**
+ * @brief Sets a bit of a bitboard to 1
+ *
+ * @param bb the bitboard.
+ * @param index index of the bit.
+ *
+ * @pre bb != NULL
+ * @post the bit is set.
+ */
+static inline void set_bit(uint64_t *bb, unsigned index){
+   bb[index / 64] |= (uint64_t)1 << (index % 64);
+}
+
+/**
+ * @brief Sets a bit of a bitboard to 0
+ *
+ * @param bb the bitboard.
+ * @param index index of the bit.
+ *
+ * @pre bb != NULL
+ * @post the bit is reset.
+ */
+static inline void reset_bit(uint64_t *bb, unsigned index){
+   bb[index / 64] &= ~((uint64_t)1 << (index % 64));
+}
+
+/**
+ * @brief Tells if a bit of a bitboard is set
+ *
+ * @param bb the bitboard.
+ * @param index index of the bit.
+ *
+ * @pre bb != NULL
+ * @post returns 1 if the bit is set, 0 otherwise.
+ */
+static inline int test_bit(const uint64_t *bb, unsigned index){
+   return (bb[index / 64] >> (index % 64)) & 1;
+}
+
+/**
+ * @brief Checks if four tokens are aligned somewhere in a bitboard
+ *
+ * @param bb the bitboard containing the tokens of one colour.
+ * @param nbWords number of words of the bitboard.
+ * @param nbLines number of lines of the grid.
+ *
+ * @pre bb != NULL
+ * @post returns 1 if four tokens are aligned (in any direction), 0 otherwise.
+ */
+int has_alignment(const uint64_t *bb, unsigned nbWords, unsigned nbLines);
+
+/**
+ * @brief Checks if a cell is part of an alignment of four tokens, by only
+ *  looking at the four lines going through that cell
+ *
+ * @remark The cell itself is considered as filled, whatever its bit is.
+ * Therefore, it can be used before or after a token is placed in the cell, in
+ * constant time whatever the size of the grid is.
+ *
+ * @param bb the bitboard containing the tokens of one colour.
+ * @param nbLines number of lines of the grid.
+ * @param nbColumns number of columns of the grid.
+ * @param index index of the bit of the cell.
+ *
+ * @pre bb != NULL, index is the bit of a cell of the grid
+ * @post returns 1 if the cell aligns four tokens, 0 otherwise.
+ */
+int aligns_four(const uint64_t *bb, unsigned nbLines, unsigned nbColumns,
+ unsigned index);
+
+/**
+ * @brief Computes one word of the mask of the cells that would complete an
+ *  alignment of four tokens
+ *
+ * @remark The mask isn't restricted to the empty or playable cells, nor to
+ * the grid itself: the caller has to filter it (with the height mask and the
+ * board mask for instance).
+ *
+ * @param bb the bitboard containing the tokens of one colour.
+ * @param nbWords number of words of the bitboard.
+ * @param nbLines number of lines of the grid.
+ * @param i index of the word wanted.
+ *
+ * @pre bb != NULL, i < nbWords
+ * @post returns the word i of the mask of the winning cells.
+ */
+uint64_t winning_cells_word(const uint64_t *bb, unsigned nbWords,
+ unsigned nbLines, unsigned i);
+
+#endif //___BITBOARD___
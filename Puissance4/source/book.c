@@ -0,0 +1,415 @@
+/**
+ * @file book.c
+ *
+ * @author Alyssia Kayembe S211023 & Jiaxiang Yao S214174
+ *
+ * @brief File implementing the functions handling the opening book of the
+ *  "A.I." of a Connect 4
+ *
+ * @date 18-10-26
+ */
+
+//mmap, fstat
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "book.h"
+
+#define BOOK_MAGIC "P4BOOK1"
+//average number of keys per bucket of the hash
+#define BUCKET_KEYS 4
+//a bucket whose keys can't be placed after that many tries makes it fail
+#define MAX_DISPLACEMENT 0xFFFFFF
+
+/**
+ * @brief Implementation of the header of the file of a book (24 bytes)
+ */
+typedef struct book_header_t{
+   char magic[8];
+   uint32_t nbLines;
+   uint32_t nbColumns;
+   uint32_t nbEntries;
+   uint32_t nbBuckets;
+}BookHeader;
+
+/**
+ * @brief Implementation of the book
+ */
+struct opening_book_t{
+   //the whole file, as mapped
+   void *memory;
+   size_t size;
+   const BookHeader *header;
+   const uint32_t *displacements;
+   const uint32_t *slots;
+   const BookEntry *entries;
+};
+
+//_________DECLARATION OF THE STATIC FUNCTIONS____________
+
+/**
+ * @brief Mixes the bits of a key (finalizer of splitmix64)
+ *
+ * @param key the key.
+ *
+ * @pre /
+ * @post returns the mixed key.
+ */
+static uint64_t mix(uint64_t key);
+
+/**
+ * @brief Gives the bucket of a key
+ *
+ * @param key the key.
+ * @param nbBuckets number of buckets.
+ *
+ * @pre nbBuckets > 0
+ * @post returns the index of the bucket.
+ */
+static uint32_t get_bucket(uint64_t key, uint32_t nbBuckets);
+
+/**
+ * @brief Gives the slot of a key, according to the displacement of its bucket
+ *
+ * @param key the key.
+ * @param displacement displacement of the bucket of the key.
+ * @param nbSlots number of slots (and of entries).
+ *
+ * @pre nbSlots > 0
+ * @post returns the index of the slot.
+ */
+static uint32_t get_slot(uint64_t key, uint32_t displacement,
+ uint32_t nbSlots);
+
+/**
+ * @brief Gives the offset of the entries in the file of a book
+ *
+ * @param nbEntries number of entries.
+ * @param nbBuckets number of buckets.
+ *
+ * @pre /
+ * @post returns the offset (in bytes), a multiple of 8.
+ */
+static size_t get_entries_offset(uint32_t nbEntries, uint32_t nbBuckets);
+
+/**
+ * @brief Compares two entries according to their key (for qsort)
+ *
+ * @param a pointer on the first entry.
+ * @param b pointer on the second entry.
+ *
+ * @pre a != NULL, b != NULL
+ * @post returns a negative, zero or positive number if the first key is
+ * smaller, equal or greater than the second one.
+ */
+static int compare_entries(const void *a, const void *b);
+
+/**
+ * @brief Builds the minimal perfect hash of a set of keys
+ *  (hash and displace: the biggest buckets are placed first)
+ *
+ * @param entries the entries (sorted by key).
+ * @param nbEntries number of entries.
+ * @param nbBuckets number of buckets.
+ * @param displacements array that will store the displacement of every bucket.
+ * @param slots array that will store the index of the entry of every slot.
+ *
+ * @pre entries != NULL, nbEntries > 0, nbBuckets > 0, displacements != NULL,
+ * slots != NULL
+ * @post the arrays are filled.
+ *
+ * @return int 1 if the hash has been built,
+ *         int -1 otherwise.
+ */
+static int build_hash(const BookEntry *entries, uint32_t nbEntries,
+ uint32_t nbBuckets, uint32_t *displacements, uint32_t *slots);
+
+//________END OF THE DECLARATION__________________________
+
+OpeningBook *open_book(const char *filename){
+   assert(filename != NULL);
+
+   int fd = open(filename, O_RDONLY);
+   if(fd == -1){
+      return NULL;
+   }
+
+   struct stat info;
+   if(fstat(fd, &info) == -1 || (size_t)info.st_size < sizeof(BookHeader)){
+      close(fd);
+      return NULL;
+   }
+
+   size_t size = (size_t)info.st_size;
+   void *memory = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+   //the mapping stays valid once the file is closed
+   close(fd);
+   if(memory == MAP_FAILED){
+      return NULL;
+   }
+
+   const BookHeader *header = memory;
+   if(memcmp(header->magic, BOOK_MAGIC, sizeof(header->magic))
+    || header->nbBuckets == 0
+    || size != get_entries_offset(header->nbEntries, header->nbBuckets)
+     + sizeof(BookEntry) * header->nbEntries){
+      munmap(memory, size);
+      return NULL;
+   }
+
+   OpeningBook *bp = malloc(sizeof(OpeningBook));
+   if(bp == NULL){
+      munmap(memory, size);
+      return NULL;
+   }
+
+   bp->memory = memory;
+   bp->size = size;
+   bp->header = header;
+   bp->displacements = (const uint32_t*)(header + 1);
+   bp->slots = bp->displacements + header->nbBuckets;
+   bp->entries = (const BookEntry*)((const char*)memory
+    + get_entries_offset(header->nbEntries, header->nbBuckets));
+
+   return bp;
+}
+
+void close_book(OpeningBook *bp){
+   if(bp == NULL){
+      return;
+   }
+   munmap(bp->memory, bp->size);
+   free(bp);
+}
+
+int probe_book(OpeningBook *bp, uint64_t key, int *column, int *score){
+   assert(bp != NULL && column != NULL && score != NULL);
+
+   const uint32_t NBENTRIES = bp->header->nbEntries;
+   if(NBENTRIES == 0){
+      return 0;
+   }
+
+   //every key gives a slot: the key stored there tells if it is the same one
+   uint32_t bucket = get_bucket(key, bp->header->nbBuckets);
+   uint32_t slot = get_slot(key, bp->displacements[bucket], NBENTRIES);
+   uint32_t index = bp->slots[slot];
+   if(index >= NBENTRIES || bp->entries[index].key != key){
+      return 0;
+   }
+
+   *column = bp->entries[index].column;
+   *score = bp->entries[index].score;
+   return 1;
+}
+
+unsigned get_book_nbLines(OpeningBook *bp){
+   assert(bp != NULL);
+   return bp->header->nbLines;
+}
+
+unsigned get_book_nbColumns(OpeningBook *bp){
+   assert(bp != NULL);
+   return bp->header->nbColumns;
+}
+
+int write_book(const char *filename, unsigned nbLines, unsigned nbColumns,
+ BookEntry *entries, unsigned nbEntries){
+   assert(filename != NULL && (entries != NULL || nbEntries == 0));
+
+   BookHeader header;
+   memset(&header, 0, sizeof(BookHeader));
+   memcpy(header.magic, BOOK_MAGIC, sizeof(header.magic));
+   header.nbLines = nbLines;
+   header.nbColumns = nbColumns;
+   header.nbEntries = nbEntries;
+   header.nbBuckets = nbEntries / BUCKET_KEYS + 1;
+
+   if(nbEntries > 0){
+      qsort(entries, nbEntries, sizeof(BookEntry), compare_entries);
+   }
+
+   //the table of the hash: the displacements, then the slots
+   uint32_t *table = calloc(header.nbBuckets + nbEntries, sizeof(uint32_t));
+   if(table == NULL){
+      return -1;
+   }
+   if(nbEntries > 0 && build_hash(entries, nbEntries, header.nbBuckets, table,
+    table + header.nbBuckets) == -1){
+      free(table);
+      return -1;
+   }
+
+   FILE *fp = fopen(filename, "wb");
+   if(fp == NULL){
+      free(table);
+      return -1;
+   }
+
+   const char PADDING[8] = {0};
+   size_t padding = get_entries_offset(nbEntries, header.nbBuckets)
+    - sizeof(BookHeader) - sizeof(uint32_t) * (header.nbBuckets + nbEntries);
+
+   int status = 1;
+   if(fwrite(&header, sizeof(BookHeader), 1, fp) != 1
+    || fwrite(table, sizeof(uint32_t), header.nbBuckets + nbEntries, fp)
+     != header.nbBuckets + nbEntries
+    || fwrite(PADDING, 1, padding, fp) != padding
+    || fwrite(entries, sizeof(BookEntry), nbEntries, fp) != nbEntries){
+      status = -1;
+   }
+
+   if(fclose(fp) == EOF){
+      status = -1;
+   }
+   free(table);
+
+   return status;
+}
+
+// ----------- STATIC FUNCTIONS --------------------
+
+static uint64_t mix(uint64_t key){
+   key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+   key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+   return key ^ (key >> 31);
+}
+
+static uint32_t get_bucket(uint64_t key, uint32_t nbBuckets){
+   assert(nbBuckets > 0);
+
+   return (uint32_t)(mix(key) % nbBuckets);
+}
+
+static uint32_t get_slot(uint64_t key, uint32_t displacement,
+ uint32_t nbSlots){
+   assert(nbSlots > 0);
+
+   return (uint32_t)(mix(key ^ ((displacement + 1) * 0x9E3779B97F4A7C15ULL))
+    % nbSlots);
+}
+
+static size_t get_entries_offset(uint32_t nbEntries, uint32_t nbBuckets){
+   size_t offset = sizeof(BookHeader)
+    + sizeof(uint32_t) * ((size_t)nbBuckets + nbEntries);
+   return (offset + 7) / 8 * 8;
+}
+
+static int compare_entries(const void *a, const void *b){
+   assert(a != NULL && b != NULL);
+
+   uint64_t keyA = ((const BookEntry*)a)->key;
+   uint64_t keyB = ((const BookEntry*)b)->key;
+   return (keyA > keyB) - (keyA < keyB);
+}
+
+static int build_hash(const BookEntry *entries, uint32_t nbEntries,
+ uint32_t nbBuckets, uint32_t *displacements, uint32_t *slots){
+   assert(entries != NULL && nbEntries > 0 && nbBuckets > 0
+    && displacements != NULL && slots != NULL);
+
+   /* the entries are grouped by bucket: first[b] is the position of the first
+    * entry of the bucket b in members, first[b + 1] the one of the next one */
+   uint32_t *first = calloc(nbBuckets + 1, sizeof(uint32_t));
+   uint32_t *members = malloc(sizeof(uint32_t) * nbEntries);
+   uint32_t *order = malloc(sizeof(uint32_t) * nbBuckets);
+   uint32_t *tried = malloc(sizeof(uint32_t) * nbEntries);
+   //first the number of members placed in each bucket, then the used slots
+   uint32_t *used = calloc(nbEntries + 1, sizeof(uint32_t));
+   if(first == NULL || members == NULL || order == NULL || tried == NULL
+    || used == NULL){
+      free(first);
+      free(members);
+      free(order);
+      free(tried);
+      free(used);
+      return -1;
+   }
+
+   for(uint32_t i = 0; i < nbEntries; ++i){
+      ++first[get_bucket(entries[i].key, nbBuckets) + 1];
+   }
+   uint32_t biggest = 0;
+   for(uint32_t b = 0; b < nbBuckets; ++b){
+      if(first[b + 1] > biggest){
+         biggest = first[b + 1];
+      }
+      first[b + 1] += first[b];
+   }
+   //the entries are sorted, so are the members of every bucket
+   for(uint32_t i = 0; i < nbEntries; ++i){
+      uint32_t b = get_bucket(entries[i].key, nbBuckets);
+      members[first[b] + used[b]] = i;
+      ++used[b];
+   }
+
+   //the buckets sorted by size, the biggest first (counting sort)
+   uint32_t nbOrdered = 0;
+   for(uint32_t size = biggest; size > 0; --size){
+      for(uint32_t b = 0; b < nbBuckets; ++b){
+         if(first[b + 1] - first[b] == size){
+            order[nbOrdered++] = b;
+         }
+      }
+   }
+
+   memset(used, 0, sizeof(uint32_t) * (nbEntries + 1));
+
+   int status = 1;
+   for(uint32_t k = 0; k < nbOrdered && status == 1; ++k){
+      const uint32_t B = order[k];
+      const uint32_t SIZE = first[B + 1] - first[B];
+      int placed = 0;
+
+      for(uint32_t d = 0; d <= MAX_DISPLACEMENT && !placed; ++d){
+         placed = 1;
+         uint32_t j;
+         for(j = 0; j < SIZE && placed; ++j){
+            uint32_t slot = get_slot(entries[members[first[B] + j]].key, d,
+             nbEntries);
+            if(used[slot]){
+               placed = 0;
+            }
+            else{
+               //marked at once, so that two keys of the bucket can't collide
+               used[slot] = 1;
+               tried[j] = slot;
+            }
+         }
+
+         if(placed){
+            displacements[B] = d;
+            for(j = 0; j < SIZE; ++j){
+               slots[tried[j]] = members[first[B] + j];
+            }
+         }
+         else{
+            //the slots marked by this try are freed
+            for(uint32_t l = 0; l + 1 < j; ++l){
+               used[tried[l]] = 0;
+            }
+         }
+      }
+
+      if(!placed){
+         status = -1;
+      }
+   }
+
+   free(first);
+   free(members);
+   free(order);
+   free(tried);
+   free(used);
+
+   return status;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file book.h
+ *
+ * @author Alyssia Kayembe S211023 & Jiaxiang Yao S214174
+ *
+ * @brief Header of the file containing the functions handling the opening
+ *  book of the "A.I." of a Connect 4
+ *
+ * @remark The book is a binary file mapped in memory as it is, without any
+ * parsing: a header, the table of a minimal perfect hash (one displacement
+ * per bucket, then one index per slot) and the entries sorted by key. A
+ * lookup costs two hashes and three memory accesses. As the file is mapped
+ * read-only, all the processes using the same book share its pages.
+ * A position and its mirror (the grid seen from behind) have the same key,
+ * only the one whose key is the smallest is stored (see get_book_key()).
+ * The numbers are stored with the byte order of the machine.
+ *
+ * @date 18-10-26
+ */
+
+#ifndef ___BOOK___
+#define ___BOOK___
+
+#include <stdint.h>
+
+/**
+ * @brief Declaration of the OpeningBook opaque type
+ */
+typedef struct opening_book_t OpeningBook;
+
+/**
+ * @brief An entry of the book (16 bytes)
+ */
+typedef struct book_entry_t{
+   //key of the canonical position (see get_book_key())
+   uint64_t key;
+   //score for the colour whose turn it is (as given by the search)
+   int32_t score;
+   //best column of the canonical position
+   uint8_t column;
+   //depth of the search, 255 if the position is solved
+   uint8_t depth;
+   uint8_t unused[2];
+}BookEntry;
+
+/**
+ * @brief Opens a book by mapping its file in memory
+ *
+ * @param filename name of the file of the book.
+ *
+ * @pre filename != NULL
+ * @post returns the address of the book, NULL if the file can't be opened or
+ * isn't a valid book.
+ */
+OpeningBook *open_book(const char *filename);
+
+/**
+ * @brief Closes a book
+ *
+ * @param bp pointer on the book.
+ *
+ * @pre /
+ * @post the file is unmapped and the book freed.
+ */
+void close_book(OpeningBook *bp);
+
+/**
+ * @brief Looks for a position in a book
+ *
+ * @param bp pointer on the book.
+ * @param key key of the canonical position.
+ * @param column a pointer that will store the best column of the canonical
+ * position.
+ * @param score a pointer that will store the score of the position.
+ *
+ * @pre bp != NULL, column != NULL, score != NULL
+ * @post the data is stored in the pointers if the position was found.
+ *
+ * @return int 1 if the position is in the book,
+ *         int 0 otherwise.
+ */
+int probe_book(OpeningBook *bp, uint64_t key, int *column, int *score);
+
+/**
+ * @brief Gets the number of lines of the grids of a book
+ *
+ * @param bp pointer on the book.
+ *
+ * @pre bp != NULL
+ * @post returns the number of lines.
+ */
+unsigned get_book_nbLines(OpeningBook *bp);
+
+/**
+ * @brief Gets the number of columns of the grids of a book
+ *
+ * @param bp pointer on the book.
+ *
+ * @pre bp != NULL
+ * @post returns the number of columns.
+ */
+unsigned get_book_nbColumns(OpeningBook *bp);
+
+/**
+ * @brief Writes a book, building its minimal perfect hash
+ *
+ * @param filename name of the file of the book.
+ * @param nbLines number of lines of the grids.
+ * @param nbColumns number of columns of the grids.
+ * @param entries the entries of the book (sorted by key by the function).
+ * @param nbEntries number of entries.
+ *
+ * @pre filename != NULL, entries != NULL or nbEntries == 0, the keys are
+ * all different
+ * @post the book is written.
+ *
+ * @return int 1 if the book has been written,
+ *         int -1 if something went wrong.
+ */
+int write_book(const char *filename, unsigned nbLines, unsigned nbColumns,
+ BookEntry *entries, unsigned nbEntries);
+
+#endif //___BOOK___
@@ -0,0 +1,712 @@
+/**
+ * @file bookgen.c
+ *
+ * @author Alyssia Kayembe S211023 & Jiaxiang Yao S214174
+ *
+ * @brief Program generating the opening book of the "A.I." of a Connect 4
+ *  (without any window)
+ *
+ * @remark Every position reachable in at most D moves is listed once (the
+ * mirrored positions and the transpositions being merged), then searched by
+ * several threads sharing one transposition table, the deepest positions
+ * first. Every result is added at once to a checkpoint file: if the program
+ * is stopped, running it again with the same options only searches the
+ * positions left. The book is written when all of them are done.
+ *
+ * @date 18-10-26
+ */
+
+//sysconf
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "model.h"
+#include "ai.h"
+#include "book.h"
+
+//depth of the entries of the positions solved
+#define SOLVED_DEPTH 255
+//positions between two progress messages
+#define PROGRESS_STEP 1000
+
+/**
+ * @brief Implementation of a position to search
+ */
+typedef struct job_t{
+   uint64_t key;
+   //index of the moves leading to the position in the array of the generator
+   size_t moves;
+   unsigned nbMoves;
+}Job;
+
+/**
+ * @brief Implementation of a set of keys (open addressing)
+ */
+typedef struct key_set_t{
+   uint64_t *keys;
+   //1 if the slot is used (the key 0 exists: the empty grid)
+   unsigned char *used;
+   //the capacity is a power of 2
+   size_t capacity;
+   size_t size;
+}KeySet;
+
+/**
+ * @brief Implementation of the data shared by the threads of the generator
+ */
+typedef struct generator_t{
+   Model *mp;
+   unsigned maxMoves;
+   Job *jobs;
+   //maxMoves moves per job
+   unsigned char *moves;
+   size_t nbJobs;
+   size_t capacity;
+   //next job to search (shared by the threads)
+   size_t next;
+   //keys of the positions of the checkpoint, sorted
+   uint64_t *done;
+   size_t nbDone;
+   //search of every position
+   unsigned depth;
+   unsigned milliseconds;
+   //checkpoint file, protected by the lock
+   FILE *checkpoint;
+   pthread_mutex_t lock;
+   size_t nbSearched;
+   size_t nbLeft;
+   time_t start;
+}Generator;
+
+//_________DECLARATION OF THE STATIC FUNCTIONS____________
+
+/**
+ * @brief Adds a key to a set
+ *
+ * @param set pointer on the set.
+ * @param key the key.
+ *
+ * @pre set != NULL
+ * @post the key is in the set.
+ *
+ * @return int 1 if the key has been added,
+ *         int 0 if it already was in the set,
+ *         int -1 if the set couldn't grow.
+ */
+static int add_key(KeySet *set, uint64_t key);
+
+/**
+ * @brief Lists the positions reachable from the current one (depth-first)
+ *
+ * @param g pointer on the generator.
+ * @param set set of the keys already listed.
+ * @param moves the moves leading to the current position.
+ *
+ * @pre g != NULL, set != NULL, moves != NULL
+ * @post the new positions are added to the jobs of the generator.
+ *
+ * @return int 1 if the positions have been listed,
+ *         int -1 if an allocation failed.
+ */
+static int list_positions(Generator *g, KeySet *set, unsigned char *moves);
+
+/**
+ * @brief Loads the keys of the positions already in the checkpoint file
+ *
+ * @param g pointer on the generator.
+ * @param filename name of the checkpoint file.
+ *
+ * @pre g != NULL, filename != NULL
+ * @post the keys are sorted in g->done (none if the file doesn't exist). An
+ * entry written only partly at the end of the file is removed, so that the
+ * entries added after it stay aligned.
+ *
+ * @return int 1 if the keys have been loaded,
+ *         int -1 if an allocation failed or the file couldn't be read or
+ *         shortened.
+ */
+static int load_checkpoint(Generator *g, const char *filename);
+
+/**
+ * @brief Tells if a position is already in the checkpoint file
+ *
+ * @param g pointer on the generator.
+ * @param key key of the position.
+ *
+ * @pre g != NULL
+ * @post returns 1 if the position has already been searched, 0 otherwise.
+ */
+static int is_done(Generator *g, uint64_t key);
+
+/**
+ * @brief Searches the positions of the generator (in each thread)
+ *
+ * @param data pointer on the generator.
+ *
+ * @pre data != NULL
+ * @post there isn't any position left.
+ */
+static void *run_worker(void *data);
+
+/**
+ * @brief Writes the book with every entry of the checkpoint file
+ *
+ * @param g pointer on the generator.
+ * @param checkpoint name of the checkpoint file.
+ * @param filename name of the book.
+ *
+ * @pre g != NULL, checkpoint != NULL, filename != NULL
+ * @post the book is written.
+ *
+ * @return int 1 if the book has been written,
+ *         int -1 otherwise.
+ */
+static int write_entries(Generator *g, const char *checkpoint,
+ const char *filename);
+
+/**
+ * @brief Compares two keys (for qsort)
+ *
+ * @param a pointer on the first key.
+ * @param b pointer on the second key.
+ *
+ * @pre a != NULL, b != NULL
+ * @post returns a negative, zero or positive number if the first key is
+ * smaller, equal or greater than the second one.
+ */
+static int compare_keys(const void *a, const void *b);
+
+/**
+ * @brief Compares two jobs, the one with the most moves first (for qsort)
+ *
+ * @param a pointer on the first job.
+ * @param b pointer on the second job.
+ *
+ * @pre a != NULL, b != NULL
+ * @post returns a negative, zero or positive number if the first job comes
+ * before, with or after the second one.
+ */
+static int compare_jobs(const void *a, const void *b);
+
+//________END OF THE DECLARATION__________________________
+
+int main(int argc, char *argv[]){
+
+   char *optstring = ":l:c:d:o:k:j:m:e:t:H";
+   int option = 0;
+   int status = 0;
+
+   unsigned nbLines = 6, nbColumns = 7;
+   unsigned maxMoves = 8;
+   char *filename = NULL;
+   char *checkpoint = NULL;
+   long nbThreads = sysconf(_SC_NPROCESSORS_ONLN);
+   int milliseconds = 0;
+   int depth = 0;
+   int tableSize = 256;
+
+   while(((option = getopt(argc, argv, optstring)) != EOF) && status != -1){
+      switch(option){
+         case 'l':
+            nbLines = atoi(optarg);
+            break;
+
+         case 'c':
+            nbColumns = atoi(optarg);
+            break;
+
+         case 'd':
+            maxMoves = atoi(optarg);
+            break;
+
+         case 'o':
+            filename = optarg;
+            break;
+
+         case 'k':
+            checkpoint = optarg;
+            break;
+
+         case 'j':
+            nbThreads = atol(optarg);
+            break;
+
+         case 'm':
+            milliseconds = atoi(optarg);
+            break;
+
+         case 'e':
+            depth = atoi(optarg);
+            break;
+
+         case 't':
+            tableSize = atoi(optarg);
+            break;
+
+         case 'H':
+            printf("AIDE OPTIONS:\n");
+            printf("-o <nom du fichier>: bibliothèque à créer (requis).\n");
+            printf("-l <nombre de lignes>: nombre de lignes du plateau (6 par défaut).\n");
+            printf("-c <nombre de colonnes>: nombre de colonnes du plateau (7 par défaut).\n");
+            printf("-d <coups>: profondeur des positions de la bibliothèque (8 par défaut).\n");
+            printf("-k <nom du fichier>: fichier de reprise (<bibliothèque>.part par défaut).\n");
+            printf("-j <nombre de threads>: threads de la recherche (tous les coeurs par défaut).\n");
+            printf("-m <millisecondes>: temps de recherche par position (optionnel).\n");
+            printf("-e <profondeur>: profondeur de recherche par position (résolution complète par défaut).\n");
+            printf("-t <taille en Mo>: mémoire de la table de transposition (256 par défaut).\n");
+            return EXIT_SUCCESS;
+
+         case '?':
+            printf("Option inconnue: %c\n", optopt);
+            status = -1;
+            break;
+
+         case ':':
+            printf("Argument manquant: %c\n", optopt);
+            status = -1;
+            break;
+
+         default:
+            printf("Une erreur inconnue s'est produite\n");
+            status = -1;
+            break;
+      }
+   }
+
+   if(status == -1){
+      printf("Une erreur au niveau des options est survenue!\n");
+      return EXIT_FAILURE;
+   }
+
+   if(filename == NULL){
+      printf("Le fichier de la bibliothèque n'a pas été donné!\n");
+      return EXIT_FAILURE;
+   }
+
+   if(nbLines < 4 || nbLines > 100 || nbColumns < 4 || nbColumns > 100
+    || maxMoves > nbLines * nbColumns || nbThreads < 1 || milliseconds < 0
+    || depth < 0 || tableSize < 0){
+      printf("Les options choisies sont invalides.\n");
+      return EXIT_FAILURE;
+   }
+
+   //the checkpoint file is next to the book by default
+   char *defaultCheckpoint = NULL;
+   if(checkpoint == NULL){
+      defaultCheckpoint = malloc(strlen(filename) + strlen(".part") + 1);
+      if(defaultCheckpoint == NULL){
+         return EXIT_FAILURE;
+      }
+      sprintf(defaultCheckpoint, "%s.part", filename);
+      checkpoint = defaultCheckpoint;
+   }
+
+   Generator g;
+   memset(&g, 0, sizeof(Generator));
+   g.maxMoves = maxMoves;
+   g.depth = (unsigned)depth;
+   g.milliseconds = (unsigned)milliseconds;
+
+   g.mp = create_model(nbLines, nbColumns);
+   KeySet set = {NULL, NULL, 0, 0};
+   unsigned char *moves = malloc(maxMoves + 1);
+   if(g.mp == NULL || moves == NULL){
+      free(defaultCheckpoint);
+      free_model(g.mp);
+      free(moves);
+      return EXIT_FAILURE;
+   }
+   initialise_game_model(g.mp, red);
+   if(set_table_size(g.mp, tableSize) == -1){
+      printf("La table de transposition n'a pas pu être créée.\n");
+   }
+
+   //every position is listed once, before the long part
+   if(list_positions(&g, &set, moves) == -1){
+      printf("Mémoire insuffisante pour lister les positions.\n");
+      status = -1;
+   }
+   else if(load_checkpoint(&g, checkpoint) == -1){
+      printf("Le fichier de reprise n'a pas pu être relu (%s).\n", checkpoint);
+      status = -1;
+   }
+   free(set.keys);
+   free(set.used);
+   free(moves);
+
+   if(status != -1){
+      qsort(g.jobs, g.nbJobs, sizeof(Job), compare_jobs);
+      for(size_t i = 0; i < g.nbJobs; ++i){
+         if(!is_done(&g, g.jobs[i].key)){
+            ++g.nbLeft;
+         }
+      }
+      printf("%zu positions, %zu déjà cherchées, %zu restantes.\n", g.nbJobs,
+       g.nbJobs - g.nbLeft, g.nbLeft);
+
+      g.checkpoint = fopen(checkpoint, "ab");
+      if(g.checkpoint == NULL){
+         printf("Le fichier de reprise n'a pas pu être ouvert (%s).\n",
+          checkpoint);
+         status = -1;
+      }
+   }
+
+   if(status != -1){
+      pthread_mutex_init(&g.lock, NULL);
+      g.start = time(NULL);
+
+      pthread_t *threads = malloc(sizeof(pthread_t) * nbThreads);
+      long nbStarted = 0;
+      if(threads != NULL){
+         while(nbStarted < nbThreads
+          && !pthread_create(&threads[nbStarted], NULL, run_worker, &g)){
+            ++nbStarted;
+         }
+      }
+      //without any thread, the main one does the work
+      if(nbStarted == 0){
+         run_worker(&g);
+      }
+      for(long i = 0; i < nbStarted; ++i){
+         pthread_join(threads[i], NULL);
+      }
+      free(threads);
+
+      pthread_mutex_destroy(&g.lock);
+      if(fclose(g.checkpoint) == EOF){
+         status = -1;
+      }
+   }
+
+   if(status != -1 && write_entries(&g, checkpoint, filename) == -1){
+      printf("La bibliothèque n'a pas pu être écrite (%s).\n", filename);
+      status = -1;
+   }
+
+   free(g.jobs);
+   free(g.moves);
+   free(g.done);
+   free_model(g.mp);
+   free(defaultCheckpoint);
+
+   return (status == -1) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// ----------- STATIC FUNCTIONS --------------------
+
+static int add_key(KeySet *set, uint64_t key){
+   assert(set != NULL);
+
+   //the set stays at most half full
+   if(2 * (set->size + 1) > set->capacity){
+      size_t capacity = set->capacity ? 2 * set->capacity : 1024;
+      uint64_t *keys = malloc(sizeof(uint64_t) * capacity);
+      unsigned char *used = calloc(capacity, 1);
+      if(keys == NULL || used == NULL){
+         free(keys);
+         free(used);
+         return -1;
+      }
+
+      for(size_t i = 0; i < set->capacity; ++i){
+         if(set->used[i]){
+            size_t j = set->keys[i] & (capacity - 1);
+            while(used[j]){
+               j = (j + 1) & (capacity - 1);
+            }
+            keys[j] = set->keys[i];
+            used[j] = 1;
+         }
+      }
+
+      free(set->keys);
+      free(set->used);
+      set->keys = keys;
+      set->used = used;
+      set->capacity = capacity;
+   }
+
+   size_t i = key & (set->capacity - 1);
+   while(set->used[i]){
+      if(set->keys[i] == key){
+         return 0;
+      }
+      i = (i + 1) & (set->capacity - 1);
+   }
+
+   set->keys[i] = key;
+   set->used[i] = 1;
+   ++set->size;
+   return 1;
+}
+
+static int list_positions(Generator *g, KeySet *set, unsigned char *moves){
+   assert(g != NULL && set != NULL && moves != NULL);
+
+   Model *mp = g->mp;
+   const unsigned NBMOVES = get_nb_moves(mp);
+   const unsigned NBCOLUMNS = get_nbColumns(mp);
+
+   //a transposition or a mirror of a position already listed
+   int mirrored;
+   uint64_t key = get_book_key(mp, &mirrored);
+   int added = add_key(set, key);
+   if(added != 1){
+      return added;
+   }
+
+   if(g->nbJobs == g->capacity){
+      size_t capacity = g->capacity ? 2 * g->capacity : 1024;
+      Job *jobs = realloc(g->jobs, sizeof(Job) * capacity);
+      if(jobs == NULL){
+         return -1;
+      }
+      g->jobs = jobs;
+      unsigned char *allMoves = realloc(g->moves, g->maxMoves * capacity + 1);
+      if(allMoves == NULL){
+         return -1;
+      }
+      g->moves = allMoves;
+      g->capacity = capacity;
+   }
+
+   g->jobs[g->nbJobs].key = key;
+   g->jobs[g->nbJobs].moves = g->maxMoves * g->nbJobs;
+   g->jobs[g->nbJobs].nbMoves = NBMOVES;
+   memcpy(g->moves + g->maxMoves * g->nbJobs, moves, NBMOVES);
+   ++g->nbJobs;
+
+   if(NBMOVES == g->maxMoves){
+      return 1;
+   }
+
+   int status = 1;
+   for(unsigned i = 0; i < NBCOLUMNS && status != -1; ++i){
+      if(check_height(mp, i)){
+         continue;
+      }
+
+      unsigned row = make_move(mp, i);
+      //the positions where the game is over don't need any move
+      if(!check_alignment(mp, row, i)
+       && get_nb_moves(mp) < get_nbLines(mp) * NBCOLUMNS){
+         moves[NBMOVES] = (unsigned char)i;
+         status = list_positions(g, set, moves);
+      }
+      unmake_move(mp, i);
+   }
+
+   return status;
+}
+
+static int load_checkpoint(Generator *g, const char *filename){
+   assert(g != NULL && filename != NULL);
+
+   FILE *fp = fopen(filename, "r+b");
+   if(fp == NULL){
+      return 1;
+   }
+
+   BookEntry entry;
+   size_t capacity = 0;
+   while(fread(&entry, sizeof(BookEntry), 1, fp) == 1){
+      if(g->nbDone == capacity){
+         capacity = capacity ? 2 * capacity : 1024;
+         uint64_t *done = realloc(g->done, sizeof(uint64_t) * capacity);
+         if(done == NULL){
+            fclose(fp);
+            return -1;
+         }
+         g->done = done;
+      }
+      g->done[g->nbDone++] = entry.key;
+   }
+
+   /* an entry written only partly (the program was stopped) is cut off:
+    * the next ones are appended right after the last whole entry */
+   long size = -1;
+   if(!ferror(fp) && fseek(fp, 0, SEEK_END) == 0){
+      size = ftell(fp);
+   }
+   int status = (size == -1) ? -1 : 1;
+   const long WHOLE = size - size % (long)sizeof(BookEntry);
+   if(status == 1 && WHOLE != size && ftruncate(fileno(fp), (off_t)WHOLE) == -1){
+      status = -1;
+   }
+   fclose(fp);
+   if(status == -1){
+      return -1;
+   }
+
+   qsort(g->done, g->nbDone, sizeof(uint64_t), compare_keys);
+   return 1;
+}
+
+static int is_done(Generator *g, uint64_t key){
+   assert(g != NULL);
+
+   size_t first = 0;
+   size_t last = g->nbDone;
+   while(first < last){
+      size_t middle = first + (last - first) / 2;
+      if(g->done[middle] < key){
+         first = middle + 1;
+      }
+      else{
+         last = middle;
+      }
+   }
+
+   return first < g->nbDone && g->done[first] == key;
+}
+
+static void *run_worker(void *data){
+   assert(data != NULL);
+
+   Generator *g = data;
+
+   //every thread has its own grid, the table is shared
+   Model *mp = duplicate_model(g->mp);
+   unsigned char *made = malloc(g->maxMoves + 1);
+   if(mp == NULL || made == NULL){
+      free_model(mp);
+      free(made);
+      return NULL;
+   }
+   set_nb_threads(mp, 1);
+   unsigned nbMade = 0;
+
+   const unsigned NBCOLUMNS = get_nbColumns(mp);
+   const unsigned NBCELLS = get_nbLines(mp) * NBCOLUMNS;
+
+   size_t i;
+   while((i = __atomic_fetch_add(&g->next, 1, __ATOMIC_RELAXED)) < g->nbJobs){
+      const Job *job = &g->jobs[i];
+      if(is_done(g, job->key)){
+         continue;
+      }
+
+      //the grid goes back to the beginning, then to the position
+      while(nbMade > 0){
+         unmake_move(mp, made[--nbMade]);
+      }
+      const unsigned char *moves = g->moves + job->moves;
+      while(nbMade < job->nbMoves){
+         make_move(mp, moves[nbMade]);
+         made[nbMade] = moves[nbMade];
+         ++nbMade;
+      }
+
+      const unsigned CELLSLEFT = NBCELLS - job->nbMoves;
+      SearchInfo info;
+      int column;
+      if(g->milliseconds > 0){
+         column = search_best_column_timed(mp, g->milliseconds, &info);
+      }
+      else{
+         unsigned depth = (g->depth == 0 || g->depth > CELLSLEFT)
+          ? CELLSLEFT : g->depth;
+         column = search_best_column(mp, depth, &info);
+      }
+      if(column == -1){
+         continue;
+      }
+
+      //the column is saved for the position whose key is the one of the book
+      int mirrored;
+      BookEntry entry;
+      memset(&entry, 0, sizeof(BookEntry));
+      entry.key = get_book_key(mp, &mirrored);
+      entry.column = (uint8_t)(mirrored ? (int)NBCOLUMNS - 1 - column : column);
+      entry.score = info.score;
+      entry.depth = (info.depth >= CELLSLEFT || info.score >= SCORE_WIN
+       || info.score <= -SCORE_WIN || info.depth >= SOLVED_DEPTH)
+       ? SOLVED_DEPTH : (uint8_t)info.depth;
+
+      pthread_mutex_lock(&g->lock);
+      if(fwrite(&entry, sizeof(BookEntry), 1, g->checkpoint) == 1){
+         fflush(g->checkpoint);
+      }
+      ++g->nbSearched;
+      if(g->nbSearched % PROGRESS_STEP == 0 || g->nbSearched == g->nbLeft){
+         printf("%zu/%zu positions (%lds)\n", g->nbSearched, g->nbLeft,
+          (long)(time(NULL) - g->start));
+         fflush(stdout);
+      }
+      pthread_mutex_unlock(&g->lock);
+   }
+
+   free(made);
+   free_model(mp);
+   return NULL;
+}
+
+static int write_entries(Generator *g, const char *checkpoint,
+ const char *filename){
+   assert(g != NULL && checkpoint != NULL && filename != NULL);
+
+   FILE *fp = fopen(checkpoint, "rb");
+   if(fp == NULL){
+      return -1;
+   }
+   if(fseek(fp, 0, SEEK_END) == -1){
+      fclose(fp);
+      return -1;
+   }
+   long size = ftell(fp);
+   rewind(fp);
+
+   size_t nbEntries = (size > 0) ? (size_t)size / sizeof(BookEntry) : 0;
+   BookEntry *entries = malloc(sizeof(BookEntry) * (nbEntries + 1));
+   if(entries == NULL){
+      fclose(fp);
+      return -1;
+   }
+   nbEntries = fread(entries, sizeof(BookEntry), nbEntries, fp);
+   fclose(fp);
+
+   //a position searched twice (the program stopped while writing) is kept once
+   qsort(entries, nbEntries, sizeof(BookEntry), compare_keys);
+   size_t nbKept = 0;
+   for(size_t i = 0; i < nbEntries; ++i){
+      if(nbKept == 0 || entries[i].key != entries[nbKept - 1].key){
+         entries[nbKept++] = entries[i];
+      }
+   }
+
+   int status = write_book(filename, get_nbLines(g->mp), get_nbColumns(g->mp),
+    entries, (unsigned)nbKept);
+   free(entries);
+
+   if(status != -1){
+      printf("%zu positions écrites dans %s.\n", nbKept, filename);
+   }
+   return status;
+}
+
+static int compare_keys(const void *a, const void *b){
+   assert(a != NULL && b != NULL);
+
+   //the key is the first field of an entry too
+   uint64_t keyA = *(const uint64_t*)a;
+   uint64_t keyB = *(const uint64_t*)b;
+   return (keyA > keyB) - (keyA < keyB);
+}
+
+static int compare_jobs(const void *a, const void *b){
+   assert(a != NULL && b != NULL);
+
+   unsigned movesA = ((const Job*)a)->nbMoves;
+   unsigned movesB = ((const Job*)b)->nbMoves;
+   return (movesA < movesB) - (movesA > movesB);
+}
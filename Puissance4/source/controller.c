@@ -18,6 +18,55 @@
 #include "controller.h"
 #include "interface.h"
 
+/**
+ * @brief Implementation of a turn of the computer, played by another thread
+ *  so that the window keeps responding while the computer thinks
+ */
+typedef struct ai_turn_t{
+   Controller *cp;
+   //copy of the model the computer thinks on (a slot of the controller)
+   Model *copy;
+   GThread *thread;
+   //column chosen by the computer
+   unsigned column;
+   //set to stop the search when the turn is cancelled
+   int cancelled;
+   //idle source bringing the column back to the main loop (0 before)
+   guint source;
+}AiTurn;
+
+/**
+ * @brief Implementation of the reply of the computer to one move of the player
+ */
+typedef struct reply_t{
+   /* position after the player's move (a slot of the controller), NULL if
+    * there is nothing to answer */
+   Model *copy;
+   //column the computer answers with
+   unsigned column;
+   //1 once the column is found
+   int done;
+}Reply;
+
+/**
+ * @brief Implementation of the search of the replies of the computer to every
+ *  move of the player, done while the player thinks
+ *
+ * @remark It uses at most the number of threads given to the computer (each
+ * search having only one), and every reply gets the time of a move.
+ */
+typedef struct speculation_t{
+   //one reply per column
+   Reply *replies;
+   unsigned nbReplies;
+   //next reply to search (shared by the threads)
+   unsigned next;
+   //set to stop every search
+   int cancelled;
+   GThread **threads;
+   unsigned nbThreads;
+}Speculation;
+
 /**
  * @brief Implementation of the controller for the Connect 4
  */
@@ -25,8 +74,150 @@ struct controller_t{
    Model *mp;
    View *vp;
    GtkWidget **pGameButtons;
+   //turn of the computer in progress, NULL if there isn't any
+   AiTurn *aiTurn;
+   //replies searched during the player's turn, NULL if there aren't any
+   Speculation *speculation;
+   /* copies of the model reused by every search: slots[0] for the turn of
+    * the computer, slots[1 + i] for the reply to column i (NULL until needed) */
+   Model **slots;
 };
 
+//_________DECLARATION OF THE STATIC FUNCTIONS_____________
+
+/**
+ * @brief Starts the turn of the computer in another thread
+ *
+ * @param cp pointer on the controller.
+ *
+ * @pre cp != NULL, the grid isn't full
+ * @post the computer is thinking on a copy of the model, its column will be
+ * played by finish_ai_turn() in the main loop. If the thread can't be
+ * created, the computer plays right away.
+ */
+static void start_ai_turn(Controller *cp);
+
+/**
+ * @brief Chooses the column of the computer (in the thread of the turn)
+ *
+ * @param data pointer on the turn.
+ *
+ * @pre data != NULL
+ * @post the column is chosen and finish_ai_turn() is added to the main loop.
+ */
+static gpointer run_ai_turn(gpointer data);
+
+/**
+ * @brief Plays the column chosen by the computer (in the main loop)
+ *
+ * @param data pointer on the turn.
+ *
+ * @pre data != NULL
+ * @post the turn is over and freed, the column is played.
+ *
+ * @return gboolean FALSE, so that the function is called only once.
+ */
+static gboolean finish_ai_turn(gpointer data);
+
+/**
+ * @brief Cancels the turn of the computer in progress (if there is one)
+ *
+ * @param cp pointer on the controller.
+ *
+ * @pre cp != NULL
+ * @post the search is stopped and the turn freed, nothing is played.
+ */
+static void cancel_ai_turn(Controller *cp);
+
+/**
+ * @brief Frees a turn of the computer whose thread is over
+ *
+ * @param turn pointer on the turn.
+ *
+ * @pre /
+ * @post the turn is freed, its copy of the model stays in the slots of
+ *       the controller and is freed by free_controller().
+ */
+static void free_ai_turn(AiTurn *turn);
+
+/**
+ * @brief Places the token of the computer and updates the window
+ *
+ * @param cp pointer on the controller.
+ * @param column index of the column chosen by the computer.
+ *
+ * @pre cp != NULL, the column isn't full
+ * @post the token is played, the game continues or ends.
+ */
+static void play_ai_turn(Controller *cp, unsigned column);
+
+/**
+ * @brief Starts searching the reply of the computer to every move the player
+ *  can make (level hard only)
+ *
+ * @param cp pointer on the controller.
+ *
+ * @pre cp != NULL, it is the player's turn
+ * @post the replies are searched by other threads. Nothing happens if they
+ * can't be created.
+ */
+static void start_speculation(Controller *cp);
+
+/**
+ * @brief Searches replies until there isn't any left (in the threads of the
+ *  speculation)
+ *
+ * @param data pointer on the speculation.
+ *
+ * @pre data != NULL
+ * @post every reply is either found or cancelled.
+ */
+static gpointer run_speculation(gpointer data);
+
+/**
+ * @brief Stops the search of the replies (if there is one) and gives the
+ *  reply to the player's move if it has already been found
+ *
+ * @param cp pointer on the controller.
+ * @param column column played by the player (-1 to only stop the search).
+ *
+ * @pre cp != NULL
+ * @post the threads are stopped and the speculation freed.
+ *
+ * @return int the column the computer answers with,
+ *         int -1 if it isn't known yet.
+ */
+static int cancel_speculation(Controller *cp, int column);
+
+/**
+ * @brief Shows the position of the model after moves have been taken back or
+ *  played again, and goes on with the game from there
+ *
+ * @param cp pointer on the controller.
+ * @param column column of the last move played again (-1 if the moves have
+ * been taken back).
+ *
+ * @pre cp != NULL, there isn't any search in progress
+ * @post the grid, the score and the buttons are up to date. The game is over
+ * if the last move ended it, otherwise the computer plays if it is its turn.
+ */
+static void show_position(Controller *cp, int column);
+
+/**
+ * @brief Gives a slot of the controller holding a copy of the current
+ *  position of the model
+ *
+ * @param cp pointer on the controller.
+ * @param index index of the slot.
+ *
+ * @pre cp != NULL, index <= nbColumns, no thread uses the slot
+ * @post returns the copy (made by duplicate_model() the first time, then by
+ * clone_model()), NULL if something went wrong.
+ */
+static Model *get_slot(Controller *cp, unsigned index);
+
+//________END OF THE DECLARATION__________________________
+
 Controller* create_controller(Model* mp, View* vp){
    assert(mp != NULL && vp != NULL);
 
@@ -37,6 +228,8 @@ Controller* create_controller(Model* mp, View* vp){
 
    cp->mp = mp;
    cp->vp = vp;
+   cp->aiTurn = NULL;
+   cp->speculation = NULL;
 
    cp->pGameButtons = malloc(sizeof(GtkWidget*) * get_nbColumns(cp->mp));
    if(cp->pGameButtons == NULL){
@@ -44,6 +237,13 @@ Controller* create_controller(Model* mp, View* vp){
       return NULL;
    }
 
+   cp->slots = calloc(get_nbColumns(cp->mp) + 1, sizeof(Model*));
+   if(cp->slots == NULL){
+      free(cp->pGameButtons);
+      free(cp);
+      return NULL;
+   }
+
    return cp;
 }
 
@@ -51,6 +251,13 @@ void free_controller(Controller* cp){
    if(cp == NULL){
       return;
    }
+   //the searches use the transposition table of the model
+   cancel_ai_turn(cp);
+   cancel_speculation(cp, -1);
+   for(unsigned i = 0; i <= get_nbColumns(cp->mp); ++i){
+      free_model(cp->slots[i]);
+   }
+   free(cp->slots);
    free(cp->pGameButtons);
    free(cp);
 }
@@ -62,7 +269,10 @@ void click_button_game(GtkWidget *pButton, gpointer data){
    unsigned int columnChosen = arg->index;
    Controller *cp = arg->cp;
 
-   //This variable will tell if the player or machine won
+   //the reply may have been found while the player was thinking
+   int reply = cancel_speculation(cp, columnChosen);
+
+   //This variable will tell if the player won
    Result result = lose;
 
    //Reacting to the player's move according to their choice
@@ -79,35 +289,22 @@ void click_button_game(GtkWidget *pButton, gpointer data){
       return;
    }
 
-  //It is the computer's turn to play
-  //This variable will allow us to also store the column chosen by the ai
-   unsigned int newColumn = 0;
-
-   rowPosition = add_token_ai(cp->mp, &newColumn, &result);
-   update_image(cp->vp, rowPosition, newColumn, get_ai_colour(cp->mp));
-
-   //Actions if the computer wins
-   if(result == win){
+   //Checking if there is a draw (the player filled the grid)
+   if(get_nb_moves(cp->mp) == get_nbLines(cp->mp) * get_nbColumns(cp->mp)){
       desactivate_all_buttons(cp);
-      show_result_label(cp->vp, lose);
+      show_result_label(cp->vp, draw);
       return;
    }
 
-   unsigned int counter = 0;
-   /* Checking if the pile of tokens in a column has reached the limit,
-      in that case we desactivate the button associated */
-   for(unsigned i = 0; i < get_nbColumns(cp->mp); ++i){
-      if(check_height(cp->mp, i)){
-         gtk_widget_set_sensitive(cp->pGameButtons[i], FALSE);
-         counter++;
-      }
+   //It is the computer's turn to play: the player has to wait for it
+   desactivate_all_buttons(cp);
+   if(reply != -1){
+      play_ai_turn(cp, reply);
    }
-
-   //Checking if there is a draw
-   if(counter == get_nbColumns(cp->mp)){
-      show_result_label(cp->vp, draw);
+   else{
+      //what was searched is still in the transposition table
+      start_ai_turn(cp);
    }
-
 }
 
 void reinitialise_game(Arguments *arg, Colour choice){
@@ -121,6 +318,10 @@ void reinitialise_game(Arguments *arg, Colour choice){
       return;
    }
 
+   //The computer mustn't play in the new game
+   cancel_ai_turn(cp);
+   cancel_speculation(cp, -1);
+
    //Initialise the game model
    initialise_game_model(cp->mp, choice);
 
@@ -135,6 +336,56 @@ void reinitialise_game(Arguments *arg, Colour choice){
    gtk_widget_show_all(pWindow);
 }
 
+void undo_game(GtkWidget *pItem, gpointer data){
+   Arguments *arg = (Arguments*) data;
+   assert(arg != NULL && arg->cp != NULL);
+
+   Controller *cp = arg->cp;
+
+   //nothing to take back before the player's first move
+   const unsigned SCORE = get_curr_player_score(cp->mp);
+   if(SCORE == 0){
+      return;
+   }
+
+   //The computer mustn't play in the position taken back
+   cancel_ai_turn(cp);
+   cancel_speculation(cp, -1);
+
+   //the computer's answer is taken back with the player's last move
+   int column = 0;
+   while(get_curr_player_score(cp->mp) == SCORE && column != -1){
+      column = undo_move(cp->mp);
+   }
+
+   show_position(cp, -1);
+}
+
+void redo_game(GtkWidget *pItem, gpointer data){
+   Arguments *arg = (Arguments*) data;
+   assert(arg != NULL && arg->cp != NULL);
+
+   Controller *cp = arg->cp;
+
+   //the computer only thinks after a new move, which can't be played again
+   int column = redo_move(cp->mp);
+   if(column == -1){
+      return;
+   }
+   cancel_speculation(cp, -1);
+
+   //the player's move comes back with the computer's answer
+   int next = 0;
+   while(get_side_to_move(cp->mp) != get_player_colour(cp->mp) && next != -1){
+      next = redo_move(cp->mp);
+      if(next != -1){
+         column = next;
+      }
+   }
+
+   show_position(cp, column);
+}
+
 // ------------ Functions for GTK ----------------
 
 void connect_buttons(Controller* cp, Arguments **arg){
@@ -256,3 +507,313 @@ Model *get_model(Controller *cp){
    assert(cp != NULL);
    return cp->mp;
 }
+
+// ----------- STATIC FUNCTIONS --------------------
+
+static void start_ai_turn(Controller *cp){
+   assert(cp != NULL);
+
+   AiTurn *turn = malloc(sizeof(AiTurn));
+   if(turn != NULL){
+      turn->cp = cp;
+      turn->column = 0;
+      turn->cancelled = 0;
+      turn->source = 0;
+      turn->thread = NULL;
+      turn->copy = get_slot(cp, 0);
+      if(turn->copy != NULL){
+         //the search of a copy leaves the age of the shared table to us
+         if(get_table(cp->mp) != NULL){
+            new_search_table(get_table(cp->mp));
+         }
+         set_stop_flag(turn->copy, &turn->cancelled);
+         turn->thread = g_thread_try_new("ai", run_ai_turn, turn, NULL);
+      }
+      if(turn->thread == NULL){
+         free_ai_turn(turn);
+         turn = NULL;
+      }
+   }
+
+   //without a thread, the window waits for the computer
+   if(turn == NULL){
+      play_ai_turn(cp, choose_column_ai(cp->mp));
+      return;
+   }
+
+   cp->aiTurn = turn;
+}
+
+static gpointer run_ai_turn(gpointer data){
+   assert(data != NULL);
+
+   AiTurn *turn = (AiTurn*) data;
+
+   turn->column = choose_column_ai(turn->copy);
+   turn->source = g_idle_add(finish_ai_turn, turn);
+
+   return NULL;
+}
+
+static gboolean finish_ai_turn(gpointer data){
+   assert(data != NULL);
+
+   AiTurn *turn = (AiTurn*) data;
+   Controller *cp = turn->cp;
+   unsigned column = turn->column;
+
+   g_thread_join(turn->thread);
+   cp->aiTurn = NULL;
+   free_ai_turn(turn);
+
+   play_ai_turn(cp, column);
+
+   return FALSE;
+}
+
+static void cancel_ai_turn(Controller *cp){
+   assert(cp != NULL);
+
+   AiTurn *turn = cp->aiTurn;
+   if(turn == NULL){
+      return;
+   }
+
+   __atomic_store_n(&turn->cancelled, 1, __ATOMIC_RELAXED);
+   g_thread_join(turn->thread);
+
+   //the column may already be on its way to the main loop
+   if(turn->source){
+      g_source_remove(turn->source);
+   }
+
+   cp->aiTurn = NULL;
+   free_ai_turn(turn);
+}
+
+static void free_ai_turn(AiTurn *turn){
+   if(turn == NULL){
+      return;
+   }
+   free(turn);
+}
+
+static void play_ai_turn(Controller *cp, unsigned column){
+   assert(cp != NULL);
+
+   //This variable will tell if the machine won
+   Result result = lose;
+
+   unsigned rowPosition = play_token_ai(cp->mp, column, &result);
+   update_image(cp->vp, rowPosition, column, get_ai_colour(cp->mp));
+
+   //Actions if the computer wins
+   if(result == win){
+      show_result_label(cp->vp, lose);
+      return;
+   }
+
+   activate_all_buttons(cp);
+
+   unsigned int counter = 0;
+   /* Checking if the pile of tokens in a column has reached the limit,
+      in that case we desactivate the button associated */
+   for(unsigned i = 0; i < get_nbColumns(cp->mp); ++i){
+      if(check_height(cp->mp, i)){
+         gtk_widget_set_sensitive(cp->pGameButtons[i], FALSE);
+         counter++;
+      }
+   }
+
+   //Checking if there is a draw
+   if(counter == get_nbColumns(cp->mp)){
+      show_result_label(cp->vp, draw);
+      return;
+   }
+
+   //the computer prepares its next reply while the player thinks
+   start_speculation(cp);
+}
+
+static void start_speculation(Controller *cp){
+   assert(cp != NULL);
+
+   if(get_level(cp->mp) != hard || cp->speculation != NULL){
+      return;
+   }
+
+   const unsigned NBCOLUMNS = get_nbColumns(cp->mp);
+   const unsigned NBCELLS = get_nbLines(cp->mp) * NBCOLUMNS;
+
+   Speculation *sp = malloc(sizeof(Speculation));
+   if(sp == NULL){
+      return;
+   }
+   sp->replies = malloc(sizeof(Reply) * NBCOLUMNS);
+   sp->threads = malloc(sizeof(GThread*) * get_nb_threads(cp->mp));
+   if(sp->replies == NULL || sp->threads == NULL){
+      free(sp->replies);
+      free(sp->threads);
+      free(sp);
+      return;
+   }
+   sp->nbReplies = NBCOLUMNS;
+   sp->next = 0;
+   sp->cancelled = 0;
+   sp->nbThreads = 0;
+
+   //a reply is needed after every move that doesn't end the game
+   unsigned nbSearches = 0;
+   for(unsigned i = 0; i < NBCOLUMNS; ++i){
+      Reply *r = &sp->replies[i];
+      r->copy = NULL;
+      r->column = 0;
+      r->done = 0;
+      if(check_height(cp->mp, i)){
+         continue;
+      }
+
+      r->copy = get_slot(cp, 1 + i);
+      if(r->copy == NULL){
+         continue;
+      }
+      unsigned row = make_move(r->copy, i);
+      if(check_alignment(r->copy, row, i) || get_nb_moves(r->copy) == NBCELLS){
+         r->copy = NULL;
+         continue;
+      }
+      set_nb_threads(r->copy, 1);
+      set_stop_flag(r->copy, &sp->cancelled);
+      ++nbSearches;
+   }
+
+   cp->speculation = sp;
+
+   /* the replies share the table: it gets older once for all of them, before
+    * any of them runs */
+   if(nbSearches > 0 && get_table(cp->mp) != NULL){
+      new_search_table(get_table(cp->mp));
+   }
+
+   for(unsigned i = 0; i < get_nb_threads(cp->mp) && i < nbSearches; ++i){
+      sp->threads[sp->nbThreads] = g_thread_try_new("speculation",
+       run_speculation, sp, NULL);
+      if(sp->threads[sp->nbThreads] == NULL){
+         break;
+      }
+      ++sp->nbThreads;
+   }
+}
+
+static gpointer run_speculation(gpointer data){
+   assert(data != NULL);
+
+   Speculation *sp = (Speculation*) data;
+
+   unsigned i;
+   while((i = __atomic_fetch_add(&sp->next, 1, __ATOMIC_RELAXED)) < sp->nbReplies
+    && !__atomic_load_n(&sp->cancelled, __ATOMIC_RELAXED)){
+      Reply *r = &sp->replies[i];
+      if(r->copy == NULL){
+         continue;
+      }
+
+      r->column = choose_column_ai(r->copy);
+      //a cancelled search may have given a worse column
+      if(!__atomic_load_n(&sp->cancelled, __ATOMIC_RELAXED)){
+         __atomic_store_n(&r->done, 1, __ATOMIC_RELEASE);
+      }
+   }
+
+   return NULL;
+}
+
+static int cancel_speculation(Controller *cp, int column){
+   assert(cp != NULL);
+
+   Speculation *sp = cp->speculation;
+   if(sp == NULL){
+      return -1;
+   }
+
+   int reply = -1;
+   if(column >= 0 && (unsigned)column < sp->nbReplies
+    && __atomic_load_n(&sp->replies[column].done, __ATOMIC_ACQUIRE)){
+      reply = (int)sp->replies[column].column;
+   }
+
+   //the searches in progress stop within a few nodes
+   __atomic_store_n(&sp->cancelled, 1, __ATOMIC_RELAXED);
+   for(unsigned i = 0; i < sp->nbThreads; ++i){
+      g_thread_join(sp->threads[i]);
+   }
+
+   //the copies are slots of the controller: they are kept for the next turn
+   free(sp->replies);
+   free(sp->threads);
+   free(sp);
+   cp->speculation = NULL;
+
+   return reply;
+}
+
+static void show_position(Controller *cp, int column){
+   assert(cp != NULL);
+
+   Model *mp = cp->mp;
+   const unsigned NBCOLUMNS = get_nbColumns(mp);
+
+   initialise_images(cp->vp);
+   update_score_label(cp->vp);
+   show_welcome_label(cp->vp);
+
+   //the last token played again may have ended the game
+   if(column >= 0){
+      unsigned row = (unsigned)(get_cases_left(mp)[column] + 1);
+      if(check_alignment(mp, row, (unsigned)column)){
+         desactivate_all_buttons(cp);
+         if(get_side_to_move(mp) == get_player_colour(mp)){
+            show_result_label(cp->vp, lose);
+         }
+         else{
+            show_result_label(cp->vp, win);
+         }
+         return;
+      }
+   }
+
+   if(get_nb_moves(mp) == get_nbLines(mp) * NBCOLUMNS){
+      desactivate_all_buttons(cp);
+      show_result_label(cp->vp, draw);
+      return;
+   }
+
+   //the computer's answer wasn't played again
+   if(get_side_to_move(mp) != get_player_colour(mp)){
+      desactivate_all_buttons(cp);
+      start_ai_turn(cp);
+      return;
+   }
+
+   activate_all_buttons(cp);
+   for(unsigned i = 0; i < NBCOLUMNS; ++i){
+      if(check_height(mp, i)){
+         gtk_widget_set_sensitive(cp->pGameButtons[i], FALSE);
+      }
+   }
+
+   start_speculation(cp);
+}
+
+static Model *get_slot(Controller *cp, unsigned index){
+   assert(cp != NULL && index <= get_nbColumns(cp->mp));
+
+   if(cp->slots[index] == NULL){
+      cp->slots[index] = duplicate_model(cp->mp);
+   }
+   else if(clone_model(cp->slots[index], cp->mp) == -1){
+      return NULL;
+   }
+
+   return cp->slots[index];
+}
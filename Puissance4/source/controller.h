@@ -77,6 +77,32 @@ void click_button_game(GtkWidget *pButton, gpointer data);
  */
 void reinitialise_game(Arguments *arg, Colour choice);
 
+/**
+ * @brief Callback function that takes back the player's last move (and the
+ *  computer's answer)
+ *
+ * @param pItem item of the menu connected to the callback function.
+ * @param data the pointer on Arguments.
+ *
+ * @pre data != NULL
+ * @post it is the player's turn again, in the position before their last
+ * move. Nothing happens if the player hasn't played yet.
+ */
+void undo_game(GtkWidget *pItem, gpointer data);
+
+/**
+ * @brief Callback function that plays again the last move taken back by
+ *  undo_game() (and the computer's answer)
+ *
+ * @param pItem item of the menu connected to the callback function.
+ * @param data the pointer on Arguments.
+ *
+ * @pre data != NULL
+ * @post the moves are played again and the game goes on from there. Nothing
+ * happens if there isn't any move to play again.
+ */
+void redo_game(GtkWidget *pItem, gpointer data);
+
 // ------------ Functions for GTK ----------------
 
 /**
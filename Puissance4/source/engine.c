@@ -0,0 +1,392 @@
+/**
+ * @file engine.c
+ *
+ * @author Alyssia Kayembe S211023 & Jiaxiang Yao S214174
+ *
+ * @brief File implementing the text protocol of the "A.I." of a Connect 4
+ *
+ * @remark The commands are read by the thread calling run_engine(), the
+ * searches are done by another one so that "stop" can be read during a
+ * search.
+ *
+ * @date 18-10-26
+ */
+
+//strtok_r
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+
+#include "engine.h"
+#include "model.h"
+#include "ai.h"
+#include "evaluation.h"
+
+//longest command (100x100 moves separated by commas)
+#define LINE_LENGTH 65536
+
+/**
+ * @brief Implementation of the state of the protocol
+ */
+typedef struct engine_t{
+   Model *mp;
+   FILE *out;
+   //the answers are written by both threads
+   pthread_mutex_t outputLock;
+   pthread_t thread;
+   //1 while the thread of a search has to be joined
+   int searching;
+   //flag of the model stopping the search
+   int stop;
+   //limits of the search (0: none)
+   unsigned milliseconds;
+   unsigned depth;
+   //column of the last iteration of the search, -1 if there isn't any
+   int lastColumn;
+   //moves expected by the search (one per cell)
+   unsigned *pv;
+   //score of each column (see evaluate_columns())
+   int *scores;
+   unsigned nbCells;
+}Engine;
+
+//_________DECLARATION OF THE STATIC FUNCTIONS____________
+
+/**
+ * @brief Writes a line of answer
+ *
+ * @param e pointer on the protocol.
+ * @param format format of the line, as printf() (without the newline).
+ *
+ * @pre e != NULL, format != NULL
+ * @post the line is written and flushed, whatever the thread writing it.
+ */
+static void write_line(Engine *e, const char *format, ...);
+
+/**
+ * @brief Sets the position of the command "position"
+ *
+ * @param e pointer on the protocol.
+ * @param moves the moves of the command.
+ *
+ * @pre e != NULL, moves != NULL, no search is running
+ * @post the model is in the position of the moves, on the empty grid if they
+ * aren't valid.
+ */
+static void set_position(Engine *e, const char *moves);
+
+/**
+ * @brief Starts the search of the command "go"
+ *
+ * @param e pointer on the protocol.
+ * @param rest the state of strtok_r() after the command (its arguments).
+ *
+ * @pre e != NULL, rest != NULL, no search is running
+ * @post the search is running, or done if its thread couldn't be created.
+ */
+static void start_search(Engine *e, char **rest);
+
+/**
+ * @brief Searches the position and writes the column found (thread of the
+ *  search)
+ *
+ * @param data pointer on the protocol.
+ *
+ * @pre data != NULL
+ * @post "bestmove" has been written.
+ */
+static void *run_search(void *data);
+
+/**
+ * @brief Writes the line "info" of an iteration of the search
+ *
+ * @param info the information about the iteration.
+ * @param data pointer on the protocol.
+ *
+ * @pre info != NULL, data != NULL
+ * @post the line is written.
+ */
+static void report_iteration(const SearchInfo *info, void *data);
+
+/**
+ * @brief Waits for the end of the search running
+ *
+ * @param e pointer on the protocol.
+ *
+ * @pre e != NULL
+ * @post no search is running.
+ */
+static void wait_search(Engine *e);
+
+/**
+ * @brief Tells if the game of the model is over
+ *
+ * @param mp pointer on the model.
+ *
+ * @pre mp != NULL
+ * @post returns 1 if the last move aligns four tokens or the grid is full,
+ * 0 otherwise.
+ */
+static int is_game_over(Model *mp);
+
+//________END OF THE DECLARATION__________________________
+
+int run_engine(Model *mp, FILE *in, FILE *out){
+   assert(mp != NULL && in != NULL && out != NULL);
+
+   Engine e;
+   memset(&e, 0, sizeof(Engine));
+   e.mp = mp;
+   e.out = out;
+   e.lastColumn = -1;
+   e.nbCells = get_nbLines(mp) * get_nbColumns(mp);
+   e.pv = malloc(sizeof(unsigned) * e.nbCells);
+   e.scores = malloc(sizeof(int) * get_nbColumns(mp));
+   char *line = malloc(LINE_LENGTH);
+   if(e.pv == NULL || e.scores == NULL || line == NULL){
+      free(e.pv);
+      free(e.scores);
+      free(line);
+      return -1;
+   }
+   pthread_mutex_init(&e.outputLock, NULL);
+   set_stop_flag(mp, &e.stop);
+
+   int quit = 0;
+   while(!quit && fgets(line, LINE_LENGTH, in) != NULL){
+      char *rest = NULL;
+      char *command = strtok_r(line, " \t\r\n", &rest);
+      if(command == NULL){
+         continue;
+      }
+
+      if(!strcmp(command, "quit")){
+         quit = 1;
+      }
+      else if(!strcmp(command, "stop")){
+         __atomic_store_n(&e.stop, 1, __ATOMIC_RELAXED);
+      }
+      else if(!strcmp(command, "isready")){
+         write_line(&e, "readyok");
+      }
+      else{
+         //the other commands use the model: the search has to be over
+         wait_search(&e);
+
+         if(!strcmp(command, "position")){
+            set_position(&e, (rest != NULL) ? rest : "");
+         }
+         else if(!strcmp(command, "go")){
+            start_search(&e, &rest);
+         }
+         else if(!strcmp(command, "eval")){
+            write_line(&e, "eval %d", evaluate_windows(mp,
+             get_side_to_move(mp)));
+         }
+         else{
+            write_line(&e, "info string commande inconnue: %s", command);
+         }
+      }
+   }
+
+   //at the end of the input, only a search without any limit is stopped
+   if(quit || (e.milliseconds == 0 && e.depth == 0)){
+      __atomic_store_n(&e.stop, 1, __ATOMIC_RELAXED);
+   }
+   wait_search(&e);
+   set_stop_flag(mp, NULL);
+
+   pthread_mutex_destroy(&e.outputLock);
+   free(e.pv);
+   free(e.scores);
+   free(line);
+
+   return 1;
+}
+
+// ----------- STATIC FUNCTIONS --------------------
+
+static void write_line(Engine *e, const char *format, ...){
+   assert(e != NULL && format != NULL);
+
+   va_list arguments;
+   va_start(arguments, format);
+
+   pthread_mutex_lock(&e->outputLock);
+   vfprintf(e->out, format, arguments);
+   fputc('\n', e->out);
+   fflush(e->out);
+   pthread_mutex_unlock(&e->outputLock);
+
+   va_end(arguments);
+}
+
+static void set_position(Engine *e, const char *moves){
+   assert(e != NULL && moves != NULL);
+
+   //the moves are taken back one by one: the table is kept
+   for(unsigned n = get_nb_moves(e->mp); n > 0; --n){
+      unmake_move(e->mp, get_move(e->mp, n - 1));
+   }
+
+   if(play_moves(e->mp, moves) == -1){
+      write_line(e, "info string coups invalides, grille vide");
+   }
+}
+
+static void start_search(Engine *e, char **rest){
+   assert(e != NULL && rest != NULL);
+
+   e->milliseconds = 0;
+   e->depth = 0;
+   int limited = 0;
+
+   char *argument;
+   while((argument = strtok_r(NULL, " \t\r\n", rest)) != NULL){
+      if(!strcmp(argument, "infinite")){
+         limited = 1;
+      }
+      else if(!strcmp(argument, "movetime") || !strcmp(argument, "depth")){
+         char *value = strtok_r(NULL, " \t\r\n", rest);
+         int number = (value != NULL) ? atoi(value) : 0;
+         if(number <= 0){
+            write_line(e, "info string valeur invalide pour %s", argument);
+            continue;
+         }
+         if(argument[0] == 'm'){
+            e->milliseconds = (unsigned)number;
+         }
+         else{
+            e->depth = (unsigned)number;
+         }
+         limited = 1;
+      }
+      else{
+         write_line(e, "info string argument inconnu: %s", argument);
+      }
+   }
+
+   //without any limit, the ones of the computer
+   if(!limited){
+      e->milliseconds = get_move_time(e->mp);
+      if(e->milliseconds == 0){
+         e->depth = get_default_depth(get_nbLines(e->mp),
+          get_nbColumns(e->mp));
+      }
+   }
+
+   if(is_game_over(e->mp)){
+      write_line(e, "bestmove none");
+      return;
+   }
+
+   e->stop = 0;
+   e->lastColumn = -1;
+   if(!pthread_create(&e->thread, NULL, run_search, e)){
+      e->searching = 1;
+   }
+   else{
+      //the search is done right away
+      run_search(e);
+   }
+}
+
+static void *run_search(void *data){
+   assert(data != NULL);
+
+   Engine *e = data;
+
+   SearchInfo info;
+   int column = search_best_column_deepening(e->mp, e->milliseconds,
+    e->depth, report_iteration, e, &info);
+
+   //stopped during the first iteration: the best column at first sight
+   if(column == -1){
+      column = e->lastColumn;
+   }
+   if(column == -1){
+      column = evaluate_columns(e->mp, e->scores);
+   }
+
+   if(column == -1){
+      write_line(e, "bestmove none");
+   }
+   else{
+      write_line(e, "bestmove %d", column + 1);
+   }
+
+   return NULL;
+}
+
+static void report_iteration(const SearchInfo *info, void *data){
+   assert(info != NULL && data != NULL);
+
+   Engine *e = data;
+   e->lastColumn = info->column;
+
+   /* the table may have lost the column of the position, the moves deeper
+    * than the iteration come from older searches */
+   unsigned length = get_principal_variation(e->mp, e->pv, info->depth);
+   if(length == 0 || e->pv[0] != (unsigned)info->column){
+      e->pv[0] = (unsigned)info->column;
+      length = 1;
+   }
+
+   char score[32];
+   const int CELLSLEFT = (int)(e->nbCells - get_nb_moves(e->mp));
+   //the score gives the tokens played until the win, counted in moves
+   //of one colour (the winning token is a move of the winner)
+   if(info->score >= SCORE_WIN){
+      const int PLIES = CELLSLEFT - (info->score - SCORE_WIN);
+      sprintf(score, "mate %d", (PLIES + 1) / 2);
+   }
+   else if(info->score <= -SCORE_WIN){
+      const int PLIES = CELLSLEFT - (-info->score - SCORE_WIN);
+      sprintf(score, "mate -%d", (PLIES + 1) / 2);
+   }
+   else{
+      sprintf(score, "%d", info->score);
+   }
+
+   const unsigned long long NPS = (info->seconds > 0)
+    ? (unsigned long long)(info->nodes / info->seconds) : info->nodes;
+
+   pthread_mutex_lock(&e->outputLock);
+   fprintf(e->out, "info depth %u score %s nodes %llu nps %llu time %.0f pv",
+    info->depth, score, info->nodes, NPS, 1000 * info->seconds);
+   for(unsigned i = 0; i < length; ++i){
+      fprintf(e->out, " %u", e->pv[i] + 1);
+   }
+   fputc('\n', e->out);
+   fflush(e->out);
+   pthread_mutex_unlock(&e->outputLock);
+}
+
+static void wait_search(Engine *e){
+   assert(e != NULL);
+
+   if(e->searching){
+      pthread_join(e->thread, NULL);
+      e->searching = 0;
+   }
+}
+
+static int is_game_over(Model *mp){
+   assert(mp != NULL);
+
+   const unsigned NBMOVES = get_nb_moves(mp);
+   if(NBMOVES == get_nbLines(mp) * get_nbColumns(mp)){
+      return 1;
+   }
+   if(NBMOVES == 0){
+      return 0;
+   }
+
+   const unsigned LAST = get_move(mp, NBMOVES - 1);
+   return check_alignment(mp, (unsigned)(get_cases_left(mp)[LAST] + 1), LAST);
+}
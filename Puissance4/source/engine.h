@@ -0,0 +1,54 @@
+/**
+ * @file engine.h
+ *
+ * @author Alyssia Kayembe S211023 & Jiaxiang Yao S214174
+ *
+ * @brief Header of the file containing the text protocol of the "A.I." of a
+ *  Connect 4, used instead of the window by other programs
+ *
+ * @remark The program reads one command per line and answers on its output
+ * (the columns are numbered from 1):
+ *  - "position [moves]": the position reached by the moves from the empty
+ * grid (see play_moves()).
+ *  - "go [movetime <ms>] [depth <n>] [infinite]": searches the position, one
+ * move deeper at a time, and writes "info depth <n> score <s> nodes <n>
+ * nps <n> time <ms> pv <columns>" after each iteration then "bestmove
+ * <column>". Without any limit, the time of the model is used (or the depth
+ * given by get_default_depth()). The score is the evaluation of the colour
+ * whose turn it is, or "mate <n>" if it wins with its n-th token from now
+ * (negative if the opponent wins with its n-th token). The commands that
+ * follow wait for the end of the search, except "stop", "isready" and
+ * "quit".
+ *  - "stop": stops the search (the column of the last iteration is given).
+ *  - "eval": writes "eval <score>", the static evaluation (see
+ * evaluate_windows()) of the colour whose turn it is.
+ *  - "isready": writes "readyok".
+ *  - "quit": stops the search and leaves. At the end of the input, the
+ * search running is finished first (unless it has no limit).
+ *
+ * @date 18-10-26
+ */
+
+#ifndef ___ENGINE___
+#define ___ENGINE___
+
+#include <stdio.h>
+
+#include "model.h"
+
+/**
+ * @brief Answers the commands of the text protocol until "quit" or the end
+ *  of the input
+ *
+ * @param mp pointer on the model (its level doesn't matter: the search of
+ * the level hard is always used).
+ * @param in the stream the commands are read from.
+ * @param out the stream the answers are written to.
+ *
+ * @pre mp != NULL, in != NULL, out != NULL
+ * @post returns 1 when the protocol is left, -1 if there wasn't enough
+ * memory to start it.
+ */
+int run_engine(Model *mp, FILE *in, FILE *out);
+
+#endif //___ENGINE___
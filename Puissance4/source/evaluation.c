@@ -0,0 +1,325 @@
+/**
+ * @file evaluation.c
+ *
+ * @author Alyssia Kayembe S211023 & Jiaxiang Yao S214174
+ *
+ * @brief File implementing the static evaluation of the moves of a Connect 4,
+ *  every column at once
+ *
+ * @date 18-10-26
+ */
+
+#include <assert.h>
+#include <stdint.h>
+
+#include "model.h"
+#include "evaluation.h"
+#include "bitboard.h"
+
+#ifdef VECTOR_X86
+#include <immintrin.h>
+#endif
+
+//Number of columns given to a kernel at once (multiple of 8)
+#define GROUP_LANES 8
+
+//_________DECLARATION OF THE STATIC FUNCTIONS_____________
+
+/**
+ * @brief Scores the drops of GROUP_LANES columns, one after another
+ *
+ * @param cells the copy of the grid (see get_cells()).
+ * @param offsets offset of the lowest empty cell of each column.
+ * @param steps offsets between two cells of a line (horizontal, vertical and
+ * both diagonals).
+ * @param own 0 if the colour whose turn it is is red, 1 if it is yellow.
+ * @param scores array that will store the score of each column (without the
+ * points of the center).
+ *
+ * @pre cells != NULL, offsets != NULL, steps != NULL, scores != NULL
+ * @post the scores are stored.
+ */
+static void score_lanes_scalar(const uint8_t *cells, const int32_t *offsets,
+ const int32_t *steps, unsigned own, int32_t *scores);
+
+#ifdef VECTOR_X86
+/**
+ * @brief Scores the drops of GROUP_LANES columns, four at a time (SSE2)
+ *
+ * @param cells the copy of the grid (see get_cells()).
+ * @param offsets offset of the lowest empty cell of each column.
+ * @param steps offsets between two cells of a line.
+ * @param own 0 if the colour whose turn it is is red, 1 if it is yellow.
+ * @param scores array that will store the score of each column.
+ *
+ * @pre cells != NULL, offsets != NULL, steps != NULL, scores != NULL, the
+ * processor has SSE2
+ * @post the scores are stored.
+ */
+static void score_lanes_sse2(const uint8_t *cells, const int32_t *offsets,
+ const int32_t *steps, unsigned own, int32_t *scores);
+
+/**
+ * @brief Scores the drops of GROUP_LANES columns, eight at a time (AVX2)
+ *
+ * @param cells the copy of the grid (see get_cells()).
+ * @param offsets offset of the lowest empty cell of each column.
+ * @param steps offsets between two cells of a line.
+ * @param own 0 if the colour whose turn it is is red, 1 if it is yellow.
+ * @param scores array that will store the score of each column.
+ *
+ * @pre cells != NULL, offsets != NULL, steps != NULL, scores != NULL, the
+ * processor has AVX2
+ * @post the scores are stored.
+ */
+static void score_lanes_avx2(const uint8_t *cells, const int32_t *offsets,
+ const int32_t *steps, unsigned own, int32_t *scores);
+#endif
+
+//________END OF THE DECLARATION__________________________
+
+int evaluate_columns(Model *mp, int *scores){
+   assert(mp != NULL && scores != NULL);
+
+   const int NBCOLUMNS = (int)get_nbColumns(mp);
+   const int WIDTH = NBCOLUMNS + 2 * CELLS_MARGIN;
+   const int32_t STEPS[4] = {1, WIDTH, WIDTH + 1, WIDTH - 1};
+   const uint8_t *cells = get_cells(mp);
+   const int *casesLeft = get_cases_left(mp);
+   const unsigned OWN = (get_side_to_move(mp) == yellow);
+
+   //the kernel is chosen once for every group
+   void (*score_lanes)(const uint8_t *, const int32_t *, const int32_t *,
+    unsigned, int32_t *) = score_lanes_scalar;
+#ifdef VECTOR_X86
+   if(__builtin_cpu_supports("avx2")){
+      score_lanes = score_lanes_avx2;
+   }
+   else if(__builtin_cpu_supports("sse2")){
+      score_lanes = score_lanes_sse2;
+   }
+#endif
+
+   int32_t offsets[GROUP_LANES];
+   int32_t results[GROUP_LANES];
+   for(int first = 0; first < NBCOLUMNS; first += GROUP_LANES){
+      //the full columns and the lanes past the grid read the first cell
+      for(int i = 0; i < GROUP_LANES; ++i){
+         int column = first + i;
+         int row = 0;
+         if(column < NBCOLUMNS && casesLeft[column] >= 0){
+            row = casesLeft[column];
+         }
+         else{
+            column = 0;
+         }
+         offsets[i] = (row + CELLS_MARGIN) * WIDTH + column + CELLS_MARGIN;
+      }
+
+      score_lanes(cells, offsets, STEPS, OWN, results);
+
+      for(int i = 0; i < GROUP_LANES && first + i < NBCOLUMNS; ++i){
+         int column = first + i;
+         if(casesLeft[column] < 0){
+            scores[column] = EVALUATION_FULL;
+         }
+         else{
+            //from 0 on the sides to 8 in the center
+            int distance = 2 * column - (NBCOLUMNS - 1);
+            if(distance < 0){
+               distance = -distance;
+            }
+            scores[column] = results[i] + 8 * (NBCOLUMNS - distance) / NBCOLUMNS;
+         }
+      }
+   }
+
+   int best = -1;
+   for(int i = 0; i < NBCOLUMNS; ++i){
+      if(scores[i] != EVALUATION_FULL && (best == -1 || scores[i] > scores[best])){
+         best = i;
+      }
+   }
+   return best;
+}
+
+// ----------- STATIC FUNCTIONS --------------------
+
+static void score_lanes_scalar(const uint8_t *cells, const int32_t *offsets,
+ const int32_t *steps, unsigned own, int32_t *scores){
+   assert(cells != NULL && offsets != NULL && steps != NULL && scores != NULL);
+
+   const unsigned OPPONENT = 1 - own;
+
+   for(unsigned lane = 0; lane < GROUP_LANES; ++lane){
+      int32_t fours = 0, blockedFours = 0, threes = 0, blockedThrees = 0;
+      int32_t twos = 0;
+
+      for(unsigned d = 0; d < 4; ++d){
+         //the 3 cells on each side of the empty one (index 3)
+         unsigned line[7];
+         for(int k = -3; k <= 3; ++k){
+            line[k + 3] = cells[offsets[lane] + k * steps[d]];
+         }
+
+         //the 4 windows going through the empty cell
+         for(unsigned start = 0; start < 4; ++start){
+            unsigned ownSum = 0, opponentSum = 0;
+            for(unsigned j = start; j < start + 4; ++j){
+               if(j != 3){
+                  ownSum += (line[j] >> own) & 1;
+                  opponentSum += (line[j] >> OPPONENT) & 1;
+               }
+            }
+            if(opponentSum == 0){
+               fours += (ownSum == 3);
+               threes += (ownSum == 2);
+               twos += (ownSum == 1);
+            }
+            if(ownSum == 0){
+               blockedFours += (opponentSum == 3);
+               blockedThrees += (opponentSum == 2);
+            }
+         }
+      }
+
+      scores[lane] = (fours << 16) + (blockedFours << 14) + (threes << 5)
+       + (blockedThrees << 4) + (twos << 2);
+   }
+}
+
+#ifdef VECTOR_X86
+__attribute__((target("sse2")))
+static void score_lanes_sse2(const uint8_t *cells, const int32_t *offsets,
+ const int32_t *steps, unsigned own, int32_t *scores){
+   assert(cells != NULL && offsets != NULL && steps != NULL && scores != NULL);
+
+   const __m128i ONE = _mm_set1_epi32(1);
+   const __m128i TWO = _mm_set1_epi32(2);
+   const __m128i THREE = _mm_set1_epi32(3);
+   const __m128i ZERO = _mm_setzero_si128();
+   const __m128i OWN = _mm_cvtsi32_si128((int)own);
+   const __m128i OPPONENT = _mm_cvtsi32_si128((int)(1 - own));
+
+   for(unsigned lane = 0; lane < GROUP_LANES; lane += 4){
+      const int32_t *o = &offsets[lane];
+      __m128i fours = ZERO, blockedFours = ZERO, threes = ZERO;
+      __m128i blockedThrees = ZERO, twos = ZERO;
+
+      for(unsigned d = 0; d < 4; ++d){
+         //SSE2 can't gather: the cells are loaded one by one
+         __m128i ownLine[7], opponentLine[7];
+         for(int k = -3; k <= 3; ++k){
+            if(k == 0){
+               ownLine[3] = opponentLine[3] = ZERO;
+               continue;
+            }
+            const int32_t STEP = k * steps[d];
+            __m128i line = _mm_setr_epi32(cells[o[0] + STEP], cells[o[1] + STEP],
+             cells[o[2] + STEP], cells[o[3] + STEP]);
+            ownLine[k + 3] = _mm_and_si128(_mm_srl_epi32(line, OWN), ONE);
+            opponentLine[k + 3] = _mm_and_si128(_mm_srl_epi32(line, OPPONENT),
+             ONE);
+         }
+
+         for(unsigned start = 0; start < 4; ++start){
+            __m128i ownSum = _mm_add_epi32(
+             _mm_add_epi32(ownLine[start], ownLine[start + 1]),
+             _mm_add_epi32(ownLine[start + 2], ownLine[start + 3]));
+            __m128i opponentSum = _mm_add_epi32(
+             _mm_add_epi32(opponentLine[start], opponentLine[start + 1]),
+             _mm_add_epi32(opponentLine[start + 2], opponentLine[start + 3]));
+
+            //the comparisons give -1 in the lanes where they are true
+            __m128i open = _mm_cmpeq_epi32(opponentSum, ZERO);
+            fours = _mm_sub_epi32(fours,
+             _mm_and_si128(open, _mm_cmpeq_epi32(ownSum, THREE)));
+            threes = _mm_sub_epi32(threes,
+             _mm_and_si128(open, _mm_cmpeq_epi32(ownSum, TWO)));
+            twos = _mm_sub_epi32(twos,
+             _mm_and_si128(open, _mm_cmpeq_epi32(ownSum, ONE)));
+
+            __m128i blocking = _mm_cmpeq_epi32(ownSum, ZERO);
+            blockedFours = _mm_sub_epi32(blockedFours,
+             _mm_and_si128(blocking, _mm_cmpeq_epi32(opponentSum, THREE)));
+            blockedThrees = _mm_sub_epi32(blockedThrees,
+             _mm_and_si128(blocking, _mm_cmpeq_epi32(opponentSum, TWO)));
+         }
+      }
+
+      __m128i score = _mm_add_epi32(_mm_slli_epi32(fours, 16),
+       _mm_slli_epi32(blockedFours, 14));
+      score = _mm_add_epi32(score, _mm_slli_epi32(threes, 5));
+      score = _mm_add_epi32(score, _mm_slli_epi32(blockedThrees, 4));
+      score = _mm_add_epi32(score, _mm_slli_epi32(twos, 2));
+      _mm_storeu_si128((__m128i *)&scores[lane], score);
+   }
+}
+
+__attribute__((target("avx2")))
+static void score_lanes_avx2(const uint8_t *cells, const int32_t *offsets,
+ const int32_t *steps, unsigned own, int32_t *scores){
+   assert(cells != NULL && offsets != NULL && steps != NULL && scores != NULL);
+
+   const __m256i ONE = _mm256_set1_epi32(1);
+   const __m256i TWO = _mm256_set1_epi32(2);
+   const __m256i THREE = _mm256_set1_epi32(3);
+   const __m256i ZERO = _mm256_setzero_si256();
+   const __m128i OWN = _mm_cvtsi32_si128((int)own);
+   const __m128i OPPONENT = _mm_cvtsi32_si128((int)(1 - own));
+
+   for(unsigned lane = 0; lane < GROUP_LANES; lane += 8){
+      const __m256i OFFSETS = _mm256_loadu_si256((const __m256i *)&offsets[lane]);
+      __m256i fours = ZERO, blockedFours = ZERO, threes = ZERO;
+      __m256i blockedThrees = ZERO, twos = ZERO;
+
+      for(unsigned d = 0; d < 4; ++d){
+         //4 bytes are gathered from each cell, only the first one is used
+         __m256i ownLine[7], opponentLine[7];
+         for(int k = -3; k <= 3; ++k){
+            if(k == 0){
+               ownLine[3] = opponentLine[3] = ZERO;
+               continue;
+            }
+            __m256i index = _mm256_add_epi32(OFFSETS,
+             _mm256_set1_epi32(k * steps[d]));
+            __m256i line = _mm256_i32gather_epi32((const int *)cells, index, 1);
+            ownLine[k + 3] = _mm256_and_si256(_mm256_srl_epi32(line, OWN), ONE);
+            opponentLine[k + 3] = _mm256_and_si256(
+             _mm256_srl_epi32(line, OPPONENT), ONE);
+         }
+
+         for(unsigned start = 0; start < 4; ++start){
+            __m256i ownSum = _mm256_add_epi32(
+             _mm256_add_epi32(ownLine[start], ownLine[start + 1]),
+             _mm256_add_epi32(ownLine[start + 2], ownLine[start + 3]));
+            __m256i opponentSum = _mm256_add_epi32(
+             _mm256_add_epi32(opponentLine[start], opponentLine[start + 1]),
+             _mm256_add_epi32(opponentLine[start + 2], opponentLine[start + 3]));
+
+            //the comparisons give -1 in the lanes where they are true
+            __m256i open = _mm256_cmpeq_epi32(opponentSum, ZERO);
+            fours = _mm256_sub_epi32(fours,
+             _mm256_and_si256(open, _mm256_cmpeq_epi32(ownSum, THREE)));
+            threes = _mm256_sub_epi32(threes,
+             _mm256_and_si256(open, _mm256_cmpeq_epi32(ownSum, TWO)));
+            twos = _mm256_sub_epi32(twos,
+             _mm256_and_si256(open, _mm256_cmpeq_epi32(ownSum, ONE)));
+
+            __m256i blocking = _mm256_cmpeq_epi32(ownSum, ZERO);
+            blockedFours = _mm256_sub_epi32(blockedFours,
+             _mm256_and_si256(blocking, _mm256_cmpeq_epi32(opponentSum, THREE)));
+            blockedThrees = _mm256_sub_epi32(blockedThrees,
+             _mm256_and_si256(blocking, _mm256_cmpeq_epi32(opponentSum, TWO)));
+         }
+      }
+
+      __m256i score = _mm256_add_epi32(_mm256_slli_epi32(fours, 16),
+       _mm256_slli_epi32(blockedFours, 14));
+      score = _mm256_add_epi32(score, _mm256_slli_epi32(threes, 5));
+      score = _mm256_add_epi32(score, _mm256_slli_epi32(blockedThrees, 4));
+      score = _mm256_add_epi32(score, _mm256_slli_epi32(twos, 2));
+      _mm256_storeu_si256((__m256i *)&scores[lane], score);
+   }
+}
+#endif
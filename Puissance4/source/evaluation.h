@@ -0,0 +1,47 @@
+/**
+ * @file evaluation.h
+ *
+ * @author Alyssia Kayembe S211023 & Jiaxiang Yao S214174
+ *
+ * @brief Header of the file containing the static evaluation of the moves of
+ *  a Connect 4, every column at once
+ *
+ * @remark Each column is a lane of a vector: the lanes read the cells around
+ * their lowest empty cell in the copy of the grid given by get_cells() (whose
+ * margins spare any bound check) and count, over the 16 windows of four cells
+ * going through it, the alignments the token would make or prevent. The
+ * kernel is chosen when the program runs: AVX2 (8 columns at once, the cells
+ * are gathered), SSE2 (4 columns) or plain C.
+ *
+ * @date 18-10-26
+ */
+
+#ifndef ___EVALUATION___
+#define ___EVALUATION___
+
+#include "model.h"
+
+/**
+ * @brief Score given to a full column by evaluate_columns()
+ */
+#define EVALUATION_FULL (-1)
+
+/**
+ * @brief Scores the move in every column for the colour whose turn it is
+ *
+ * @remark A token scores, in the windows still open around it, 1 << 16 if it
+ * aligns four tokens, 1 << 14 if it prevents four tokens of the other colour,
+ * 32 per three in a row made, 16 per three in a row prevented, 4 per two in a
+ * row made, and up to 8 more points the closer it is to the center.
+ *
+ * @param mp pointer on the model.
+ * @param scores array that will store the score of each column (nbColumns
+ * elements), EVALUATION_FULL for the full columns.
+ *
+ * @pre mp != NULL, scores != NULL
+ * @post the scores are stored. Returns the index of the column with the best
+ * score (the first one if several are equal), -1 if the grid is full.
+ */
+int evaluate_columns(Model *mp, int *scores);
+
+#endif //___EVALUATION___
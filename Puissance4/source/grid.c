@@ -0,0 +1,77 @@
+/**
+ * @file grid.c
+ *
+ * @author Alyssia Kayembe S211023 & Jiaxiang Yao S214174
+ *
+ * @brief File implementing the packed grid of a Connect 4
+ *
+ * @date 18-10-26
+ */
+
+//posix_memalign
+#define _POSIX_C_SOURCE 200112L
+
+#include <assert.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "grid.h"
+
+#define CACHE_LINE 64
+
+PackedGrid *create_packed_grid(unsigned nbLines, unsigned nbColumns){
+   assert(nbLines > 0 && nbColumns > 0);
+
+   const unsigned COLUMN_WORDS = (nbLines + CELLS_PER_WORD - 1) / CELLS_PER_WORD;
+
+   //the grid takes the first cache line of the block, the cells the others
+   void *memory = NULL;
+   if(posix_memalign(&memory, CACHE_LINE,
+    CACHE_LINE + sizeof(uint64_t) * COLUMN_WORDS * nbColumns)){
+      return NULL;
+   }
+
+   PackedGrid *grid = memory;
+   grid->words = (uint64_t *)((char *)memory + CACHE_LINE);
+   grid->nbLines = nbLines;
+   grid->nbColumns = nbColumns;
+   grid->columnWords = COLUMN_WORDS;
+   clear_packed_grid(grid);
+
+   return grid;
+}
+
+void free_packed_grid(PackedGrid *grid){
+   free(grid);
+}
+
+void clear_packed_grid(PackedGrid *grid){
+   assert(grid != NULL);
+
+   memset(grid->words, 0, get_packed_grid_size(grid));
+}
+
+void copy_packed_grid(PackedGrid *destination, const PackedGrid *source){
+   assert(destination != NULL && source != NULL
+    && destination->nbLines == source->nbLines
+    && destination->nbColumns == source->nbColumns);
+
+   memcpy(destination->words, source->words, get_packed_grid_size(source));
+}
+
+size_t get_packed_grid_size(const PackedGrid *grid){
+   assert(grid != NULL);
+
+   return sizeof(uint64_t) * grid->columnWords * grid->nbColumns;
+}
+
+void unpack_grid(const PackedGrid *grid, Colour **gameGrid){
+   assert(grid != NULL && gameGrid != NULL);
+
+   for(unsigned j = 0; j < grid->nbColumns; ++j){
+      for(unsigned i = 0; i < grid->nbLines; ++i){
+         gameGrid[i][j] = get_packed_cell(grid, i, j);
+      }
+   }
+}
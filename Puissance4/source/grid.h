@@ -0,0 +1,149 @@
+/**
+ * @file grid.h
+ *
+ * @author Alyssia Kayembe S211023 & Jiaxiang Yao S214174
+ *
+ * @brief Header of the file containing the packed grid of a Connect 4
+ *
+ * @remark The grid is stored in one block of memory aligned on a cache line,
+ * column by column since the tokens are played in the columns. Each cell
+ * takes 2 bits (its Colour) and each column starts on a new 64 bits word:
+ * the cell (row, column), where row 0 is the top of the grid, is in the bits
+ * 2 * (row % 32) of the word column * columnWords + row / 32. A grid of 6x7
+ * takes 7 words, one of 100x100 takes 400 words (3200 bytes), and copying a
+ * grid is a single memcpy().
+ *
+ * @date 18-10-26
+ */
+
+#ifndef ___GRID___
+#define ___GRID___
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "model.h"
+
+/**
+ * @brief Number of bits of a cell
+ */
+#define CELL_BITS 2
+
+/**
+ * @brief Number of cells in a 64 bits word
+ */
+#define CELLS_PER_WORD 32
+
+/**
+ * @brief Implementation of the packed grid (declared in model.h)
+ */
+struct packed_grid_t{
+   //cells of the grid, column after column (aligned on a cache line)
+   uint64_t *words;
+   unsigned nbLines;
+   unsigned nbColumns;
+   //number of words of a column
+   unsigned columnWords;
+};
+
+/**
+ * @brief Creates an empty packed grid
+ *
+ * @param nbLines number of lines of the grid.
+ * @param nbColumns number of columns of the grid.
+ *
+ * @pre nbLines > 0, nbColumns > 0
+ * @post returns the address of the grid (every cell is none), NULL if
+ * something went wrong. The grid and its cells are one block of memory.
+ */
+PackedGrid *create_packed_grid(unsigned nbLines, unsigned nbColumns);
+
+/**
+ * @brief Frees a packed grid
+ *
+ * @param grid the grid.
+ *
+ * @pre /
+ * @post the grid is freed.
+ */
+void free_packed_grid(PackedGrid *grid);
+
+/**
+ * @brief Empties a packed grid
+ *
+ * @param grid the grid.
+ *
+ * @pre grid != NULL
+ * @post every cell is none.
+ */
+void clear_packed_grid(PackedGrid *grid);
+
+/**
+ * @brief Copies the cells of a packed grid into another one
+ *
+ * @param destination the grid receiving the cells.
+ * @param source the grid copied.
+ *
+ * @pre destination != NULL, source != NULL, the grids have the same size
+ * @post the cells of destination are the ones of source.
+ */
+void copy_packed_grid(PackedGrid *destination, const PackedGrid *source);
+
+/**
+ * @brief Gives the number of bytes of the cells of a packed grid
+ *
+ * @param grid the grid.
+ *
+ * @pre grid != NULL
+ * @post returns the size of the cells in memory (a multiple of 8).
+ */
+size_t get_packed_grid_size(const PackedGrid *grid);
+
+/**
+ * @brief Writes the cells of a packed grid in a grid of Colour
+ *
+ * @param grid the packed grid.
+ * @param gameGrid the grid receiving the cells (see create_game_grid()).
+ *
+ * @pre grid != NULL, gameGrid != NULL, the grids have the same size
+ * @post gameGrid[row][column] is the colour of every cell.
+ */
+void unpack_grid(const PackedGrid *grid, Colour **gameGrid);
+
+/**
+ * @brief Gives the colour of a cell of a packed grid
+ *
+ * @param grid the grid.
+ * @param row index of the line of the cell (0 is the top of the grid).
+ * @param column index of the column of the cell.
+ *
+ * @pre grid != NULL, row < nbLines, column < nbColumns
+ * @post returns the colour of the cell.
+ */
+static inline Colour get_packed_cell(const PackedGrid *grid, unsigned row,
+ unsigned column){
+   const uint64_t WORD = grid->words[column * grid->columnWords
+    + row / CELLS_PER_WORD];
+   return (Colour)((WORD >> (CELL_BITS * (row % CELLS_PER_WORD))) & 3);
+}
+
+/**
+ * @brief Changes the colour of a cell of a packed grid
+ *
+ * @param grid the grid.
+ * @param row index of the line of the cell (0 is the top of the grid).
+ * @param column index of the column of the cell.
+ * @param colour the new colour of the cell.
+ *
+ * @pre grid != NULL, row < nbLines, column < nbColumns
+ * @post the cell has the colour.
+ */
+static inline void set_packed_cell(PackedGrid *grid, unsigned row,
+ unsigned column, Colour colour){
+   uint64_t *word = &grid->words[column * grid->columnWords
+    + row / CELLS_PER_WORD];
+   const unsigned SHIFT = CELL_BITS * (row % CELLS_PER_WORD);
+   *word = (*word & ~((uint64_t)3 << SHIFT)) | ((uint64_t)colour << SHIFT);
+}
+
+#endif //___GRID___
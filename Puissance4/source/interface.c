@@ -208,6 +208,8 @@ GtkWidget *create_menu(GtkWidget *pWindow, Arguments **arg){
    //create items for menu "Partie"
    GtkWidget *itemGame = gtk_menu_item_new_with_mnemonic("_Partie");
    GtkWidget *itemReplay = gtk_menu_item_new_with_mnemonic("_Redemarrer une partie");
+   GtkWidget *itemUndo = gtk_menu_item_new_with_mnemonic("_Annuler le coup");
+   GtkWidget *itemRedo = gtk_menu_item_new_with_mnemonic("R_établir le coup");
    GtkWidget *itemTop10 = gtk_menu_item_new_with_mnemonic("_TOP 10");
    GtkWidget *itemMode = gtk_menu_item_new_with_mnemonic("_Changer le mode du jeu");
    GtkWidget *itemSeparator = gtk_separator_menu_item_new();
@@ -215,12 +217,16 @@ GtkWidget *create_menu(GtkWidget *pWindow, Arguments **arg){
 
    gtk_widget_add_accelerator(itemQuit, "activate", accelerator, GDK_q, GDK_CONTROL_MASK, GTK_ACCEL_VISIBLE);
    gtk_widget_add_accelerator(itemReplay, "activate", accelerator, GDK_r, GDK_CONTROL_MASK, GTK_ACCEL_VISIBLE);
+   gtk_widget_add_accelerator(itemUndo, "activate", accelerator, GDK_z, GDK_CONTROL_MASK, GTK_ACCEL_VISIBLE);
+   gtk_widget_add_accelerator(itemRedo, "activate", accelerator, GDK_y, GDK_CONTROL_MASK, GTK_ACCEL_VISIBLE);
    gtk_widget_add_accelerator(itemTop10, "activate", accelerator, GDK_t, GDK_CONTROL_MASK, GTK_ACCEL_VISIBLE);
    gtk_widget_add_accelerator(itemMode, "activate", accelerator, GDK_m, GDK_CONTROL_MASK, GTK_ACCEL_VISIBLE);
 
    //attach items to "Partie"
    gtk_menu_item_set_submenu(GTK_MENU_ITEM(itemGame), menuGame);
    gtk_menu_shell_append(GTK_MENU_SHELL(menuGame), itemReplay);
+   gtk_menu_shell_append(GTK_MENU_SHELL(menuGame), itemUndo);
+   gtk_menu_shell_append(GTK_MENU_SHELL(menuGame), itemRedo);
    gtk_menu_shell_append(GTK_MENU_SHELL(menuGame), itemTop10);
    gtk_menu_shell_append(GTK_MENU_SHELL(menuGame), itemMode);
    gtk_menu_shell_append(GTK_MENU_SHELL(menuGame), itemSeparator);
@@ -248,5 +254,7 @@ GtkWidget *create_menu(GtkWidget *pWindow, Arguments **arg){
    g_signal_connect(G_OBJECT(itemTop10), "activate", G_CALLBACK(create_pop_up_top10), arg[0]);
    g_signal_connect(G_OBJECT(itemMode), "activate", G_CALLBACK(create_pop_up_mode), arg[0]);
    g_signal_connect(G_OBJECT(itemReplay), "activate", G_CALLBACK(create_pop_up_restart), arg[0]);
+   g_signal_connect(G_OBJECT(itemUndo), "activate", G_CALLBACK(undo_game), arg[0]);
+   g_signal_connect(G_OBJECT(itemRedo), "activate", G_CALLBACK(redo_game), arg[0]);
    return menuBar;
 }
@@ -19,10 +19,11 @@
 #include "view.h"
 #include "controller.h"
 #include "interface.h"
+#include "engine.h"
 
 int main(int argc, char *argv[]){
 
-   char *optstring = ":n:l:c:f:Hp:";
+   char *optstring = ":n:l:c:f:Hp:a:t:m:s:b:e";
    int option = 0;
    int status = 0;
 
@@ -34,8 +35,25 @@ int main(int argc, char *argv[]){
 
    int colour = 0;
 
+   Level level = easy;
+
    unsigned int nbLines = 6, nbColumns = 7;
 
+   //size of the transposition table in MB (-1: the default one)
+   int tableSize = -1;
+
+   //time given to the computer for each move in ms (0: fixed depth)
+   int moveTime = 0;
+
+   //number of threads of the search of the computer
+   int nbThreads = 1;
+
+   //opening book of the computer (NULL: none)
+   char *bookFile = NULL;
+
+   //1 to answer the text protocol instead of opening the window
+   int engineMode = 0;
+
    while(((option = getopt(argc, argv, optstring)) != EOF) && status != -1){
       switch(option){
          //Mendatory option
@@ -71,6 +89,38 @@ int main(int argc, char *argv[]){
             }
             break;
 
+         case 't':
+            tableSize = atoi(optarg);
+            if(tableSize < 0 || tableSize > 4096){
+               printf("taille de la table de transposition invalide.\n");
+               return EXIT_FAILURE;
+            }
+            break;
+
+         case 'm':
+            moveTime = atoi(optarg);
+            if(moveTime < 0){
+               printf("temps de réflexion invalide.\n");
+               return EXIT_FAILURE;
+            }
+            break;
+
+         case 's':
+            nbThreads = atoi(optarg);
+            if(nbThreads < 1 || nbThreads > 256){
+               printf("nombre de threads invalide.\n");
+               return EXIT_FAILURE;
+            }
+            break;
+
+         case 'b':
+            bookFile = optarg;
+            break;
+
+         case 'e':
+            engineMode = 1;
+            break;
+
          case 'p':
             if(!strcmp(optarg, "rouge")){
                colour = red;
@@ -80,13 +130,35 @@ int main(int argc, char *argv[]){
             }
             break;
 
+         case 'a':
+            if(!strcmp(optarg, "facile")){
+               level = easy;
+            }
+            else if(!strcmp(optarg, "difficile")){
+               level = hard;
+            }
+            else if(!strcmp(optarg, "montecarlo")){
+               level = montecarlo;
+            }
+            else{
+               printf("Niveau inconnu: %s\n", optarg);
+               status = -1;
+            }
+            break;
+
          case 'H':
             printf("AIDE OPTIONS:\n");
             printf("-f <nom du fichier>: pour afficher les meilleurs scores (requis).\n");
             printf("-n <nom du joueur>: permet d'enregistrer le nom du joueur (optionnel).\n");
             printf("-l <nombre de lignes>: nombre de lignes du plateau (optionnel).\n");
             printf("-c <nombre de colonnes>: nombre de colonnes du plateau (optionnel).\n");
+            printf("-t <taille en Mo>: mémoire de la table de transposition (optionnel).\n");
+            printf("-m <millisecondes>: temps de réflexion de l'ordinateur par coup (optionnel).\n");
+            printf("-b <nom du fichier>: bibliothèque d'ouvertures de l'ordinateur (optionnel).\n");
+            printf("-s <nombre de threads>: threads de la recherche de l'ordinateur (optionnel).\n");
             printf("-j <rouge ou jaune>: couleur du joueur (optionnel).\n");
+            printf("-a <facile, difficile ou montecarlo>: niveau de l'ordinateur (optionnel).\n");
+            printf("-e: répond au protocole texte sur l'entrée et la sortie standard au lieu d'ouvrir la fenêtre (optionnel).\n");
             return EXIT_SUCCESS;
             break;
 
@@ -113,7 +185,7 @@ int main(int argc, char *argv[]){
       return EXIT_FAILURE;
    }
 
-   if(!fileCheck){
+   if(!fileCheck && !engineMode){
       printf("Le fichier contenant les meilleurs scores n'a pas été ajouté!\n");
       return EXIT_FAILURE;
    }
@@ -123,7 +195,7 @@ int main(int argc, char *argv[]){
       return EXIT_FAILURE;
    }
 
-   if(nameCheck){
+   if(nameCheck && !engineMode){
       printf("Bienvenue, %s! Bonne chance..\n", name);
    }
 
@@ -136,6 +208,27 @@ int main(int argc, char *argv[]){
       return EXIT_FAILURE;
    }
 
+   //Saving the options of the game and of the computer
+   initialise_game_model(mp, colour);
+   set_level(mp, level);
+   set_move_time(mp, moveTime);
+   set_nb_threads(mp, nbThreads);
+   //without any window, the standard output only carries the protocol
+   FILE *messages = engineMode ? stderr : stdout;
+   if(tableSize >= 0 && set_table_size(mp, tableSize) == -1){
+      fprintf(messages, "La table de transposition n'a pas pu être créée.\n");
+   }
+   if(bookFile != NULL && set_book(mp, bookFile) == -1){
+      fprintf(messages, "La bibliothèque d'ouvertures n'a pas pu être ouverte.\n");
+   }
+
+   //without any window, the commands are read on the standard input
+   if(engineMode){
+      status = run_engine(mp, stdin, stdout);
+      free_model(mp);
+      return (status == -1) ? EXIT_FAILURE : EXIT_SUCCESS;
+   }
+
       //VIEW
    View *vp = create_view(mp);
    if(vp == NULL){
@@ -157,7 +250,6 @@ int main(int argc, char *argv[]){
    if(nameCheck){
       set_name(mp, name);
    }
-   initialise_game_model(mp, colour);
    set_highscores_file(mp, filename);
    load_highscores(mp);
 
@@ -173,9 +265,10 @@ int main(int argc, char *argv[]){
    //Array of arguments
    Arguments **arg = create_arg_array(nbColumns, pWindow);
    if(arg == NULL){
+      //same order as at the end: the controller uses the model
+      free_controller(cp);
       free_view(vp);
       free_model(mp);
-      free_controller(cp);
       return EXIT_FAILURE;
    }
 
@@ -199,10 +292,11 @@ int main(int argc, char *argv[]){
    gtk_main();
 
    //We free all the pointers we created dynamically
+   //the controller stops the computer before the model is freed
    free_arguments_array(arg, nbColumns);
+   free_controller(cp);
    free_view(vp);
    free_model(mp);
-   free_controller(cp);
 
    return EXIT_SUCCESS;
 }
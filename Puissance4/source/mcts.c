@@ -0,0 +1,779 @@
+/**
+ * @file mcts.c
+ *
+ * @author Alyssia Kayembe S211023 & Jiaxiang Yao S214174
+ *
+ * @brief File implementing the Monte Carlo tree search of the "A.I." of a
+ *  Connect 4
+ *
+ * @date 18-10-26
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include <string.h>
+
+#include "model.h"
+#include "ai.h"
+#include "mcts.h"
+#include "playout.h"
+#include "timing.h"
+
+//Number of random games of a search without any time given
+#define DEFAULT_PLAYOUTS 20000
+//The clock is read every CHECK_PLAYOUTS games
+#define CHECK_PLAYOUTS 64
+//Exploration constant of UCT
+#define EXPLORATION 1.4
+//Random games played from each leaf when they fit the kernel of playout.h
+#define PLAYOUT_BATCH 4
+
+/**
+ * @brief What is known about the position of a node
+ */
+typedef enum{unexplored, ongoing, won, drawn}NodeState;
+
+/**
+ * @brief Implementation of a node of the tree (16 bytes)
+ *
+ * @remark The children of a node are contiguous in the arena. The points are
+ * the ones of the colour who played the move leading to the node: 2 per game
+ * won, 1 per draw.
+ * The threads share the nodes: the counters and the state are only read and
+ * written with atomic operations. A node is visited as soon as a thread goes
+ * through it, its points only come with the result of the game (virtual
+ * loss), so that the other threads try other moves meanwhile. The children
+ * are added by the thread that sets expanding first and published by storing
+ * firstChild last.
+ */
+typedef struct node_t{
+   //0 if the children haven't been added yet
+   uint32_t firstChild;
+   uint32_t visits;
+   uint32_t points;
+   uint8_t nbChildren;
+   uint8_t column;
+   //NodeState
+   uint8_t state;
+   //1 while a thread adds the children
+   uint8_t expanding;
+}Node;
+
+/**
+ * @brief Implementation of the tree of the search
+ */
+struct mcts_t{
+   //the node 0 of an arena is never used (0 means "no node")
+   Node *arenas[2];
+   //index of the arena in use
+   unsigned current;
+   uint32_t capacity;
+   uint32_t used;
+   uint32_t root;
+   //Zobrist key of the position of the root
+   uint64_t rootHash;
+   uint64_t random;
+};
+
+/**
+ * @brief Implementation of what the threads of a search share
+ */
+typedef struct control_t{
+   Mcts *tree;
+   double start;
+   unsigned milliseconds;
+   //games left when the search has no time given
+   long long playoutsLeft;
+   //set when every thread must stop
+   int stop;
+}Control;
+
+/**
+ * @brief Implementation of a thread of the search
+ *
+ * @remark Every thread plays its games on its own copy of the model (the
+ * first thread uses the model given to the search).
+ */
+typedef struct worker_t{
+   pthread_t thread;
+   Control *control;
+   Model *mp;
+   uint64_t random;
+   unsigned long long playouts;
+   //nodes of the current path
+   uint32_t *path;
+   //moves of the current random game
+   unsigned *moves;
+   //columns that aren't full during the random game
+   unsigned *columns;
+   //games played from each leaf (PLAYOUT_BATCH or 1)
+   unsigned nbGames;
+   Colour outcomes[PLAYOUT_BATCH];
+}Worker;
+
+//_________DECLARATION OF THE STATIC FUNCTIONS____________
+
+/**
+ * @brief Empties the tree and gives it a new root
+ *
+ * @param tree pointer on the tree.
+ * @param hash Zobrist key of the position of the root.
+ *
+ * @pre tree != NULL
+ * @post the tree only has its root.
+ */
+static void reset_tree(Mcts *tree, uint64_t hash);
+
+/**
+ * @brief Copies the subtree of a node into the other arena, which becomes the
+ *  one in use (the node being the new root)
+ *
+ * @param tree pointer on the tree.
+ * @param node index of the node.
+ *
+ * @pre tree != NULL, node is in the arena in use
+ * @post the arena in use only contains the subtree.
+ */
+static void compact_tree(Mcts *tree, uint32_t node);
+
+/**
+ * @brief Adds the children of a node (one per column that isn't full), the
+ *  columns of the center first
+ *
+ * @param tree pointer on the tree.
+ * @param node pointer on the node.
+ * @param mp pointer on the model (at the position of the node).
+ *
+ * @pre tree != NULL, node != NULL, mp != NULL
+ * @post the children are added, unless the arena is full or another thread
+ * is adding them.
+ */
+static void expand_node(Mcts *tree, Node *node, Model *mp);
+
+/**
+ * @brief Chooses the child to go down to (UCT)
+ *
+ * @param tree pointer on the tree.
+ * @param node pointer on the node.
+ * @param firstChild index of the first child of the node.
+ *
+ * @pre tree != NULL, node != NULL, the node has children
+ * @post returns a pointer on the child.
+ */
+static Node *select_child(Mcts *tree, Node *node, uint32_t firstChild);
+
+/**
+ * @brief Goes down the tree, adds a node and gives the result of random
+ *  games back to the nodes of the path
+ *
+ * @param w pointer on the thread.
+ *
+ * @pre w != NULL
+ * @post the model of the thread is in the same state as before, the games
+ * are added to the ones of the thread. Returns 1 if
+ * the path was a winning move of the root, 0 otherwise.
+ */
+static int run_playout(Worker *w);
+
+/**
+ * @brief Plays games until the search is over
+ *
+ * @param data pointer on the thread (Worker *).
+ *
+ * @pre data != NULL
+ * @post the number of games played is stored in the thread. Returns NULL.
+ */
+static void *run_worker(void *data);
+
+/**
+ * @brief Plays a random game from the current position of the model
+ *
+ * @param w pointer on the thread (for its model, arrays and random numbers).
+ *
+ * @pre w != NULL
+ * @post the model is in the same state as before. Returns the colour who won
+ * the game, none if it is a draw.
+ */
+static Colour play_random_game(Worker *w);
+
+/**
+ * @brief Gives a random number (xorshift64*)
+ *
+ * @param state pointer on the state of the generator.
+ *
+ * @pre state != NULL, *state != 0
+ * @post returns a random number.
+ */
+static uint64_t next_random(uint64_t *state);
+
+/**
+ * @brief Prepares the threads of a search (the first one runs in the
+ *  calling thread)
+ *
+ * @param control pointer on what the threads share.
+ * @param mp pointer on the model.
+ * @param nbWorkers a pointer that will store the number of threads ready.
+ *
+ * @pre control != NULL, mp != NULL, nbWorkers != NULL
+ * @post returns the array of the threads, NULL if not even the first one
+ * could be prepared.
+ */
+static Worker *create_workers(Control *control, Model *mp,
+ unsigned *nbWorkers);
+
+/**
+ * @brief Frees the threads of a search (and the copies of the model)
+ *
+ * @param workers the array of the threads.
+ * @param nbWorkers number of threads.
+ *
+ * @pre /
+ * @post the threads are freed.
+ */
+static void free_workers(Worker *workers, unsigned nbWorkers);
+
+//________END OF THE DECLARATION__________________________
+
+Mcts *create_mcts(unsigned nbNodes){
+   assert(nbNodes > 1);
+
+   Mcts *tree = malloc(sizeof(Mcts));
+   if(tree == NULL){
+      return NULL;
+   }
+
+   tree->arenas[0] = malloc(sizeof(Node) * nbNodes);
+   tree->arenas[1] = malloc(sizeof(Node) * nbNodes);
+   if(tree->arenas[0] == NULL || tree->arenas[1] == NULL){
+      free(tree->arenas[0]);
+      free(tree->arenas[1]);
+      free(tree);
+      return NULL;
+   }
+
+   tree->capacity = nbNodes;
+   tree->current = 0;
+   tree->random = (uint64_t)time(NULL) * 0x9E3779B97F4A7C15ULL | 1;
+   reset_tree(tree, 0);
+
+   return tree;
+}
+
+void free_mcts(Mcts *tree){
+   if(tree == NULL){
+      return;
+   }
+   free(tree->arenas[0]);
+   free(tree->arenas[1]);
+   free(tree);
+}
+
+void clear_mcts(Mcts *tree){
+   assert(tree != NULL);
+
+   reset_tree(tree, 0);
+}
+
+void play_mcts_move(Mcts *tree, uint64_t hash, unsigned column,
+ uint64_t newHash){
+   assert(tree != NULL);
+
+   Node *arena = tree->arenas[tree->current];
+   Node *root = &arena[tree->root];
+
+   //the tree may be the one of another position
+   uint32_t child = 0;
+   if(tree->rootHash == hash){
+      for(unsigned i = 0; i < root->nbChildren && root->firstChild; ++i){
+         if(arena[root->firstChild + i].column == column){
+            child = root->firstChild + i;
+         }
+      }
+   }
+
+   if(child == 0){
+      reset_tree(tree, newHash);
+      return;
+   }
+
+   //the nodes outside the subtree are lost: they are removed when they are many
+   if(tree->used > tree->capacity / 2){
+      compact_tree(tree, child);
+   }
+   else{
+      tree->root = child;
+   }
+   tree->rootHash = newHash;
+}
+
+int search_mcts(Mcts *tree, Model *mp, unsigned milliseconds,
+ SearchInfo *info){
+   assert(tree != NULL && mp != NULL);
+
+   int bookColumn = get_book_column(mp, info);
+   if(bookColumn != -1){
+      return bookColumn;
+   }
+
+   if(get_nb_moves(mp) == get_nbLines(mp) * get_nbColumns(mp)){
+      return -1;
+   }
+
+   if(tree->rootHash != get_hash(mp)){
+      reset_tree(tree, get_hash(mp));
+   }
+
+   Control control;
+   control.tree = tree;
+   control.start = get_time();
+   control.milliseconds = milliseconds;
+   control.playoutsLeft = DEFAULT_PLAYOUTS;
+   control.stop = 0;
+
+   unsigned nbWorkers;
+   Worker *workers = create_workers(&control, mp, &nbWorkers);
+   if(workers == NULL){
+      return -1;
+   }
+
+   //the other threads go down the same tree, the first one is this one
+   unsigned nbStarted = 1;
+   for(unsigned i = 1; i < nbWorkers; ++i){
+      if(pthread_create(&workers[i].thread, NULL, run_worker, &workers[i])){
+         break;
+      }
+      ++nbStarted;
+   }
+   run_worker(&workers[0]);
+
+   unsigned long long playouts = workers[0].playouts;
+   for(unsigned i = 1; i < nbStarted; ++i){
+      pthread_join(workers[i].thread, NULL);
+      playouts += workers[i].playouts;
+   }
+   free_workers(workers, nbWorkers);
+
+   //the most visited column is the safest one, a winning one is played at once
+   Node *arena = tree->arenas[tree->current];
+   Node *root = &arena[tree->root];
+   Node *best = NULL;
+   for(unsigned i = 0; i < root->nbChildren && root->firstChild; ++i){
+      Node *child = &arena[root->firstChild + i];
+      if(child->state == won){
+         best = child;
+         break;
+      }
+      if(best == NULL || child->visits > best->visits){
+         best = child;
+      }
+   }
+
+   int column = -1;
+   if(best != NULL && best->visits > 0){
+      column = best->column;
+   }
+
+   if(info != NULL){
+      info->column = column;
+      info->score = 0;
+      info->depth = 0;
+      if(column != -1){
+         info->score = (int)(1000.0 * best->points / best->visits) - 1000;
+
+         //length of the line of the most visited nodes
+         Node *node = best;
+         info->depth = 1;
+         while(node->firstChild){
+            Node *next = &arena[node->firstChild];
+            for(unsigned i = 1; i < node->nbChildren; ++i){
+               if(arena[node->firstChild + i].visits > next->visits){
+                  next = &arena[node->firstChild + i];
+               }
+            }
+            if(next->visits == 0){
+               break;
+            }
+            node = next;
+            ++info->depth;
+         }
+      }
+      info->nodes = playouts;
+      info->seconds = get_time() - control.start;
+   }
+
+   return column;
+}
+
+// ----------- STATIC FUNCTIONS --------------------
+
+static void reset_tree(Mcts *tree, uint64_t hash){
+   assert(tree != NULL);
+
+   Node *root = &tree->arenas[tree->current][1];
+   root->firstChild = 0;
+   root->visits = 0;
+   root->points = 0;
+   root->nbChildren = 0;
+   root->column = 0;
+   root->state = ongoing;
+   root->expanding = 0;
+
+   tree->root = 1;
+   tree->used = 2;
+   tree->rootHash = hash;
+}
+
+static void compact_tree(Mcts *tree, uint32_t node){
+   assert(tree != NULL);
+
+   const Node *source = tree->arenas[tree->current];
+   Node *destination = tree->arenas[1 - tree->current];
+
+   //breadth first: the children of a node stay contiguous
+   destination[1] = source[node];
+   uint32_t used = 2;
+   for(uint32_t i = 1; i < used; ++i){
+      Node *n = &destination[i];
+      if(n->firstChild){
+         for(unsigned j = 0; j < n->nbChildren; ++j){
+            destination[used + j] = source[n->firstChild + j];
+         }
+         n->firstChild = used;
+         used += n->nbChildren;
+      }
+   }
+
+   tree->current = 1 - tree->current;
+   tree->root = 1;
+   tree->used = used;
+}
+
+static void expand_node(Mcts *tree, Node *node, Model *mp){
+   assert(tree != NULL && node != NULL && mp != NULL);
+
+   uint8_t expected = 0;
+   if(!__atomic_compare_exchange_n(&node->expanding, &expected, 1, 0,
+    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)){
+      return;
+   }
+   if(__atomic_load_n(&node->firstChild, __ATOMIC_ACQUIRE)){
+      __atomic_store_n(&node->expanding, 0, __ATOMIC_RELEASE);
+      return;
+   }
+
+   const unsigned NBCOLUMNS = get_nbColumns(mp);
+   unsigned nbChildren = 0;
+   for(unsigned i = 0; i < NBCOLUMNS; ++i){
+      if(!check_height(mp, i)){
+         ++nbChildren;
+      }
+   }
+
+   //the nodes are reserved without any lock, unless the arena is full
+   uint32_t first = __atomic_load_n(&tree->used, __ATOMIC_RELAXED);
+   do{
+      if(nbChildren == 0 || first + nbChildren > tree->capacity){
+         //once the arena is full, the leaves stay leaves
+         __atomic_store_n(&node->expanding, 0, __ATOMIC_RELEASE);
+         return;
+      }
+   }while(!__atomic_compare_exchange_n(&tree->used, &first,
+    first + nbChildren, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+   Node *children = &tree->arenas[tree->current][first];
+   unsigned k = 0;
+   int left = (int)(NBCOLUMNS - 1) / 2;
+   int right = left + 1;
+   for(unsigned i = 0; i < NBCOLUMNS; ++i){
+      int column;
+      if(left >= 0 && (i % 2 == 0 || right >= (int)NBCOLUMNS)){
+         column = left--;
+      }
+      else{
+         column = right++;
+      }
+      if(check_height(mp, column)){
+         continue;
+      }
+
+      children[k].firstChild = 0;
+      children[k].visits = 0;
+      children[k].points = 0;
+      children[k].nbChildren = 0;
+      children[k].column = (uint8_t)column;
+      children[k].state = unexplored;
+      children[k].expanding = 0;
+      ++k;
+   }
+
+   //the children are visible to the other threads once firstChild is set
+   node->nbChildren = (uint8_t)nbChildren;
+   __atomic_store_n(&node->firstChild, first, __ATOMIC_RELEASE);
+}
+
+static Node *select_child(Mcts *tree, Node *node, uint32_t firstChild){
+   assert(tree != NULL && node != NULL && firstChild);
+
+   Node *children = &tree->arenas[tree->current][firstChild];
+   const double LOGVISITS =
+    log((double)__atomic_load_n(&node->visits, __ATOMIC_RELAXED) + 1);
+
+   Node *best = &children[0];
+   double bestValue = -1;
+   for(unsigned i = 0; i < node->nbChildren; ++i){
+      Node *child = &children[i];
+      uint32_t visits = __atomic_load_n(&child->visits, __ATOMIC_RELAXED);
+
+      //a winning move is always played, an unvisited child is visited first
+      if(__atomic_load_n(&child->state, __ATOMIC_RELAXED) == won
+       || visits == 0){
+         return child;
+      }
+
+      uint32_t points = __atomic_load_n(&child->points, __ATOMIC_RELAXED);
+      double value = points / (2.0 * visits)
+       + EXPLORATION * sqrt(LOGVISITS / visits);
+      if(value > bestValue){
+         bestValue = value;
+         best = child;
+      }
+   }
+
+   return best;
+}
+
+static int run_playout(Worker *w){
+   assert(w != NULL);
+
+   Mcts *tree = w->control->tree;
+   Model *mp = w->mp;
+   const unsigned NBCELLS = get_nbLines(mp) * get_nbColumns(mp);
+   const Colour COLOUR = get_side_to_move(mp);
+   const Colour OPPONENT = (COLOUR == red) ? yellow : red;
+
+   Node *arena = tree->arenas[tree->current];
+   Node *node = &arena[tree->root];
+   unsigned length = 0;
+   uint8_t state = ongoing;
+   uint32_t visits = __atomic_add_fetch(&node->visits, 1, __ATOMIC_RELAXED);
+   w->path[length++] = tree->root;
+
+   //selection: down to a node without children or whose game is over
+   uint32_t firstChild = __atomic_load_n(&node->firstChild, __ATOMIC_ACQUIRE);
+   while(firstChild && state != won && state != drawn){
+      node = select_child(tree, node, firstChild);
+      //the visit comes before the result: a virtual loss until then
+      visits = __atomic_add_fetch(&node->visits, 1, __ATOMIC_RELAXED);
+      unsigned row = make_move(mp, node->column);
+      w->path[length++] = (uint32_t)(node - arena);
+
+      state = __atomic_load_n(&node->state, __ATOMIC_RELAXED);
+      if(state == unexplored){
+         if(check_alignment(mp, row, node->column)){
+            state = won;
+         }
+         else if(get_nb_moves(mp) == NBCELLS){
+            state = drawn;
+         }
+         else{
+            state = ongoing;
+         }
+         __atomic_store_n(&node->state, state, __ATOMIC_RELAXED);
+      }
+      firstChild = __atomic_load_n(&node->firstChild, __ATOMIC_ACQUIRE);
+   }
+
+   //expansion of the nodes already visited once
+   unsigned nbGames = 1;
+   //games won by each colour, wins[none] being the draws
+   unsigned wins[3] = {0, 0, 0};
+   if(state == won){
+      ++wins[(get_side_to_move(mp) == red) ? yellow : red];
+   }
+   else if(state == drawn){
+      ++wins[none];
+   }
+   else{
+      if(visits > 1 || length == 1){
+         expand_node(tree, node, mp);
+      }
+      if(w->nbGames > 1){
+         nbGames = w->nbGames;
+         play_random_games(mp, nbGames, &w->random, w->outcomes);
+         for(unsigned i = 0; i < nbGames; ++i){
+            ++wins[w->outcomes[i]];
+         }
+      }
+      else{
+         ++wins[play_random_game(w)];
+      }
+   }
+   w->playouts += nbGames;
+
+   //the results go back up, each node seen by the colour who played it (the
+   //first game has been counted on the way down)
+   Colour mover = (length % 2 == 1) ? OPPONENT : COLOUR;
+   for(unsigned i = length; i-- > 0;){
+      Node *n = &arena[w->path[i]];
+      if(nbGames > 1){
+         __atomic_fetch_add(&n->visits, nbGames - 1, __ATOMIC_RELAXED);
+      }
+      unsigned points = 2 * wins[mover] + wins[none];
+      if(points > 0){
+         __atomic_fetch_add(&n->points, points, __ATOMIC_RELAXED);
+      }
+      if(i > 0){
+         unmake_move(mp, n->column);
+      }
+      mover = (mover == red) ? yellow : red;
+   }
+
+   return length == 2 && state == won;
+}
+
+static void *run_worker(void *data){
+   assert(data != NULL);
+
+   Worker *w = data;
+   Control *control = w->control;
+   int *stop = get_stop_flag(w->mp);
+
+   while(!__atomic_load_n(&control->stop, __ATOMIC_RELAXED)){
+      //a winning move of the root ends the search
+      unsigned long long before = w->playouts;
+      int finished = run_playout(w);
+
+      if(control->milliseconds == 0){
+         if(__atomic_sub_fetch(&control->playoutsLeft,
+          (long long)(w->playouts - before), __ATOMIC_RELAXED) <= 0){
+            finished = 1;
+         }
+      }
+      else if(w->playouts / CHECK_PLAYOUTS != before / CHECK_PLAYOUTS){
+         if(get_time() - control->start >= control->milliseconds / 1000.0){
+            finished = 1;
+         }
+      }
+      if(stop != NULL && __atomic_load_n(stop, __ATOMIC_RELAXED)){
+         finished = 1;
+      }
+
+      if(finished){
+         __atomic_store_n(&control->stop, 1, __ATOMIC_RELAXED);
+      }
+   }
+
+   return NULL;
+}
+
+static Colour play_random_game(Worker *w){
+   assert(w != NULL);
+
+   Model *mp = w->mp;
+   const unsigned NBCOLUMNS = get_nbColumns(mp);
+   unsigned nbColumns = 0;
+   for(unsigned i = 0; i < NBCOLUMNS; ++i){
+      if(!check_height(mp, i)){
+         w->columns[nbColumns++] = i;
+      }
+   }
+
+   Colour winner = none;
+   unsigned nbMoves = 0;
+   while(nbColumns > 0 && winner == none){
+      unsigned k = (unsigned)(next_random(&w->random) % nbColumns);
+      unsigned column = w->columns[k];
+
+      Colour colour = get_side_to_move(mp);
+      unsigned row = make_move(mp, column);
+      w->moves[nbMoves++] = column;
+
+      if(check_alignment(mp, row, column)){
+         winner = colour;
+      }
+      //a full column is replaced by the last one of the array
+      if(check_height(mp, column)){
+         w->columns[k] = w->columns[--nbColumns];
+      }
+   }
+
+   while(nbMoves > 0){
+      unmake_move(mp, w->moves[--nbMoves]);
+   }
+
+   return winner;
+}
+
+static uint64_t next_random(uint64_t *state){
+   assert(state != NULL);
+
+   *state ^= *state >> 12;
+   *state ^= *state << 25;
+   *state ^= *state >> 27;
+   return *state * 0x2545F4914F6CDD1DULL;
+}
+
+static Worker *create_workers(Control *control, Model *mp,
+ unsigned *nbWorkers){
+   assert(control != NULL && mp != NULL && nbWorkers != NULL);
+
+   *nbWorkers = 0;
+   const unsigned NBTHREADS = get_nb_threads(mp);
+   //the path goes at most to a full grid, the random game too
+   const unsigned CELLSLEFT =
+    get_nbLines(mp) * get_nbColumns(mp) - get_nb_moves(mp);
+
+   Worker *workers = malloc(sizeof(Worker) * NBTHREADS);
+   if(workers == NULL){
+      return NULL;
+   }
+
+   for(unsigned i = 0; i < NBTHREADS; ++i){
+      Worker *w = &workers[*nbWorkers];
+      w->control = control;
+      w->playouts = 0;
+      w->random = next_random(&control->tree->random) | 1;
+      w->mp = (i == 0) ? mp : duplicate_model(mp);
+      w->path = malloc(sizeof(uint32_t) * (CELLSLEFT + 1));
+      w->moves = malloc(sizeof(unsigned) * (CELLSLEFT + 1));
+      w->columns = malloc(sizeof(unsigned) * get_nbColumns(mp));
+      //the vector kernel only helps the grids of 64 bits
+      w->nbGames = strcmp(get_playout_kernel(mp), "model") ? PLAYOUT_BATCH : 1;
+      if(w->mp == NULL || w->path == NULL || w->moves == NULL
+       || w->columns == NULL){
+         if(i > 0){
+            free_model(w->mp);
+         }
+         free(w->path);
+         free(w->moves);
+         free(w->columns);
+         break;
+      }
+      ++*nbWorkers;
+   }
+
+   if(*nbWorkers == 0){
+      free(workers);
+      return NULL;
+   }
+   return workers;
+}
+
+static void free_workers(Worker *workers, unsigned nbWorkers){
+   if(workers == NULL){
+      return;
+   }
+   for(unsigned i = 0; i < nbWorkers; ++i){
+      if(i > 0){
+         free_model(workers[i].mp);
+      }
+      free(workers[i].path);
+      free(workers[i].moves);
+      free(workers[i].columns);
+   }
+   free(workers);
+}
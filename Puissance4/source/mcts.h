@@ -0,0 +1,113 @@
+/**
+ * @file mcts.h
+ *
+ * @author Alyssia Kayembe S211023 & Jiaxiang Yao S214174
+ *
+ * @brief Header of the file containing the Monte Carlo tree search of the
+ *  "A.I." of a Connect 4 (level "montecarlo"), made for the big grids
+ *
+ * @remark The search repeats four steps: it goes down the tree by choosing the
+ * most promising child of each node (UCT), adds the children of the node
+ * reached, plays random games from there and gives their results back to
+ * every node of the path (several games at once with the kernel of
+ * playout.h when the grid fits in 64 bits, one on the model itself
+ * otherwise). The column played is the most visited one.
+ * The nodes are taken from an arena allocated once. After each real move, the
+ * tree is kept from the child of that move (the arena is compacted into a
+ * second one when it is more than half full).
+ * With several threads (see set_nb_threads()), every thread plays its games
+ * on its own copy of the model but they all go down the same tree, without
+ * any lock: a node counts as lost for the threads going through it until
+ * the result of their game comes back (virtual loss), so that they spread
+ * over different lines.
+ *
+ * @date 18-10-26
+ */
+
+#ifndef ___MCTS___
+#define ___MCTS___
+
+#include <stdint.h>
+
+#include "model.h"
+
+/**
+ * @brief Declaration of the Mcts opaque type (the tree of the search)
+ */
+typedef struct mcts_t Mcts;
+
+/**
+ * @brief Creates the tree of a Monte Carlo search
+ *
+ * @param nbNodes number of nodes of each of the two arenas.
+ *
+ * @pre nbNodes > 1
+ * @post returns the address of the tree (empty), NULL if something went
+ * wrong.
+ */
+Mcts *create_mcts(unsigned nbNodes);
+
+/**
+ * @brief Frees the tree of a Monte Carlo search
+ *
+ * @param tree pointer on the tree.
+ *
+ * @pre /
+ * @post the tree is freed.
+ */
+void free_mcts(Mcts *tree);
+
+/**
+ * @brief Removes every node of the tree
+ *
+ * @param tree pointer on the tree.
+ *
+ * @pre tree != NULL
+ * @post the tree is empty, the next search starts from scratch.
+ */
+void clear_mcts(Mcts *tree);
+
+/**
+ * @brief Moves the root of the tree after a real move, keeping its subtree
+ *
+ * @param tree pointer on the tree.
+ * @param hash Zobrist key of the position before the move.
+ * @param column index of the column played.
+ * @param newHash Zobrist key of the position after the move.
+ *
+ * @pre tree != NULL
+ * @post the root is the node of the new position (the tree is emptied if it
+ * wasn't the one of the position before the move).
+ */
+void play_mcts_move(Mcts *tree, uint64_t hash, unsigned column,
+ uint64_t newHash);
+
+/**
+ * @brief Searches the best column for the colour whose turn it is with a
+ *  Monte Carlo tree search
+ *
+ * @remark The random games are played on the model itself: it is in the same
+ * state after the search as before. The threads of the model (see
+ * get_nb_threads()) all play games until the time is up. The score given is the mean result of the
+ * games of the column (from -1000, always lost, to 1000, always won), the
+ * nodes are the number of games played and the depth the length of the most
+ * visited line.
+ *
+ * @param tree pointer on the tree.
+ * @param mp pointer on the model.
+ * @param milliseconds time the search may take, 0 to play a fixed number of
+ * random games instead.
+ * @param info a pointer that will store the information about the search
+ * (can be NULL).
+ *
+ * @pre tree != NULL, mp != NULL
+ * @post returns the index of the best column found, -1 if the grid is full or
+ * the search was stopped before any game.
+ *
+ * @return int index of the column,
+ *         int -1 if there is no column left or the search was stopped.
+ */
+int search_mcts(Mcts *tree, Model *mp, unsigned milliseconds,
+ SearchInfo *info);
+
+#endif //___MCTS___
@@ -0,0 +1,827 @@
+/**
+ * @file microbench.c
+ *
+ * @author Alyssia Kayembe S211023 & Jiaxiang Yao S214174
+ *
+ * @brief Program measuring the cost of the functions of the model and of the
+ *  "A.I." called the most often (without any window)
+ *
+ * @remark check_grid(), every verify_* function, add_token_player() and
+ * add_token_ai() are run on the same positions at each run: for each board
+ * size (6x7, 7x9, 20x20 and 100x100), POSITIONS positions more and more full
+ * are played from a fixed seed. A token added is taken back at once with
+ * undo_move() (included in the measure), so that the positions don't change.
+ * Each measure is repeated and the fastest one is kept. The results are
+ * written in JSON, one benchmark per line: a file written by the program can
+ * be given back as a baseline, the program then fails if a benchmark got
+ * slower than the threshold allows. The cycles are counted by
+ * perf_event_open() when the system allows it (null otherwise).
+ *
+ * @date 18-10-26
+ */
+
+//syscall
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <getopt.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#endif
+
+#include "model.h"
+#include "ai.h"
+#include "timing.h"
+
+//number of positions of each board size
+#define POSITIONS 16
+//seed of the moves of the positions
+#define BENCH_SEED 0x50554953u
+//length of the names in the baseline
+#define NAME_LENGTH 64
+
+/**
+ * @brief Implementation of a position the functions are run on
+ */
+typedef struct position_t{
+   Model *mp;
+   //copy of the lowest empty cell of each column (see get_cases_left())
+   int *casesLeft;
+}Position;
+
+/**
+ * @brief Signature shared by the verify_* functions
+ */
+typedef int (*Verifier)(int range, const PackedGrid *grid, int *casesLeft,
+ Colour colour, int i, const int NBLINES, const int NBCOLUMNS);
+
+/**
+ * @brief Implementation of a benchmark
+ */
+typedef struct benchmark_t{
+   const char *name;
+   //verify_* function measured (NULL for the other benchmarks)
+   Verifier verifier;
+   //runs the benchmark once on a position and returns the number of calls
+   unsigned long (*run)(const struct benchmark_t *b, Position *p);
+}Benchmark;
+
+/**
+ * @brief Implementation of a result read in the baseline
+ */
+typedef struct baseline_t{
+   char name[NAME_LENGTH];
+   char board[NAME_LENGTH];
+   double nsPerOp;
+}Baseline;
+
+//_________DECLARATION OF THE STATIC FUNCTIONS____________
+
+/**
+ * @brief Plays a position from the empty grid with random moves, none of
+ *  them winning
+ *
+ * @param nbLines number of lines of the grid.
+ * @param nbColumns number of columns of the grid.
+ * @param nbMoves number of moves wanted.
+ * @param state state of the random numbers.
+ *
+ * @pre state != NULL, nbMoves < nbLines * nbColumns
+ * @post returns the model of the position (less moves than wanted if no move
+ * could be played without winning), NULL if something went wrong.
+ */
+static Model *play_position(unsigned nbLines, unsigned nbColumns,
+ unsigned nbMoves, uint64_t *state);
+
+/**
+ * @brief Gives the next random number
+ *
+ * @param state state of the random numbers.
+ *
+ * @pre state != NULL
+ * @post returns a random number and changes the state.
+ */
+static uint64_t next_random(uint64_t *state);
+
+/**
+ * @brief Runs check_grid() with a range of 2 for both colours
+ *
+ * @param b the benchmark.
+ * @param p the position.
+ *
+ * @pre b != NULL, p != NULL
+ * @post returns the number of calls.
+ */
+static unsigned long run_check_grid_2(const Benchmark *b, Position *p);
+
+/**
+ * @brief Runs check_grid() with a range of 3 for both colours
+ *
+ * @param b the benchmark.
+ * @param p the position.
+ *
+ * @pre b != NULL, p != NULL
+ * @post returns the number of calls.
+ */
+static unsigned long run_check_grid_3(const Benchmark *b, Position *p);
+
+/**
+ * @brief Runs a verify_* function on every column that isn't full, with the
+ *  ranges 2 and 3 and both colours
+ *
+ * @param b the benchmark.
+ * @param p the position.
+ *
+ * @pre b != NULL, b->verifier != NULL, p != NULL
+ * @post returns the number of calls.
+ */
+static unsigned long run_verifier(const Benchmark *b, Position *p);
+
+/**
+ * @brief Runs add_token_player() (and undo_move()) on every column that
+ *  isn't full
+ *
+ * @param b the benchmark.
+ * @param p the position.
+ *
+ * @pre b != NULL, p != NULL
+ * @post returns the number of calls, the position didn't change.
+ */
+static unsigned long run_add_token_player(const Benchmark *b, Position *p);
+
+/**
+ * @brief Runs add_token_ai() (and undo_move()) once
+ *
+ * @param b the benchmark.
+ * @param p the position.
+ *
+ * @pre b != NULL, p != NULL
+ * @post returns the number of calls, the position didn't change.
+ */
+static unsigned long run_add_token_ai(const Benchmark *b, Position *p);
+
+//the verify_* functions with the signature of a Verifier
+static int verify_down_bench(int range, const PackedGrid *grid,
+ int *casesLeft, Colour colour, int i, const int NBLINES,
+ const int NBCOLUMNS);
+static int verify_right_bench(int range, const PackedGrid *grid,
+ int *casesLeft, Colour colour, int i, const int NBLINES,
+ const int NBCOLUMNS);
+static int verify_left_bench(int range, const PackedGrid *grid,
+ int *casesLeft, Colour colour, int i, const int NBLINES,
+ const int NBCOLUMNS);
+static int verify_down_right_bench(int range, const PackedGrid *grid,
+ int *casesLeft, Colour colour, int i, const int NBLINES,
+ const int NBCOLUMNS);
+static int verify_down_left_bench(int range, const PackedGrid *grid,
+ int *casesLeft, Colour colour, int i, const int NBLINES,
+ const int NBCOLUMNS);
+static int verify_up_right_bench(int range, const PackedGrid *grid,
+ int *casesLeft, Colour colour, int i, const int NBLINES,
+ const int NBCOLUMNS);
+static int verify_up_left_bench(int range, const PackedGrid *grid,
+ int *casesLeft, Colour colour, int i, const int NBLINES,
+ const int NBCOLUMNS);
+static int verify_within_row_bench(int range, const PackedGrid *grid,
+ int *casesLeft, Colour colour, int i, const int NBLINES,
+ const int NBCOLUMNS);
+static int verify_within_diagonal_left_bench(int range,
+ const PackedGrid *grid, int *casesLeft, Colour colour, int i,
+ const int NBLINES, const int NBCOLUMNS);
+static int verify_within_diagonal_right_bench(int range,
+ const PackedGrid *grid, int *casesLeft, Colour colour, int i,
+ const int NBLINES, const int NBCOLUMNS);
+
+/**
+ * @brief Measures a benchmark on the positions of a board size
+ *
+ * @param b the benchmark.
+ * @param positions the positions.
+ * @param minTime shortest time of a measure in seconds.
+ * @param repetitions number of measures.
+ * @param cycles file descriptor of the counter of cycles (-1 if there is
+ * none).
+ * @param nsPerOp a pointer that will store the time of a call in ns.
+ * @param cyclesPerOp a pointer that will store the cycles of a call (-1 if
+ * they aren't counted).
+ *
+ * @pre b != NULL, positions != NULL, repetitions > 0, nsPerOp != NULL,
+ * cyclesPerOp != NULL
+ * @post the time and cycles of the fastest measure are stored. Returns the
+ * number of calls of that measure.
+ */
+static unsigned long measure(const Benchmark *b, Position *positions,
+ double minTime, unsigned repetitions, int cycles, double *nsPerOp,
+ double *cyclesPerOp);
+
+/**
+ * @brief Opens the counter of the cycles of the thread
+ *
+ * @pre /
+ * @post returns the file descriptor of the counter (disabled), -1 if the
+ * system doesn't allow it.
+ */
+static int open_cycles(void);
+
+/**
+ * @brief Starts counting the cycles from 0
+ *
+ * @param cycles file descriptor of the counter (-1 if there is none).
+ *
+ * @pre /
+ * @post the counter is enabled.
+ */
+static void start_cycles(int cycles);
+
+/**
+ * @brief Stops counting the cycles
+ *
+ * @param cycles file descriptor of the counter (-1 if there is none).
+ *
+ * @pre /
+ * @post returns the cycles counted since start_cycles(), -1 if they couldn't
+ * be read.
+ */
+static double stop_cycles(int cycles);
+
+/**
+ * @brief Reads the results of a file written by the program
+ *
+ * @param filename name of the file.
+ * @param nbResults a pointer that will store the number of results.
+ *
+ * @pre filename != NULL, nbResults != NULL
+ * @post returns the results read (to free), NULL if the file couldn't be
+ * read.
+ */
+static Baseline *read_baseline(const char *filename, size_t *nbResults);
+
+/**
+ * @brief Looks for a result in the baseline
+ *
+ * @param baseline the results of the baseline.
+ * @param nbResults number of results.
+ * @param name name of the benchmark.
+ * @param board size of the board ("6x7" for instance).
+ *
+ * @pre name != NULL, board != NULL
+ * @post returns the result, NULL if the baseline doesn't have it.
+ */
+static const Baseline *find_baseline(const Baseline *baseline,
+ size_t nbResults, const char *name, const char *board);
+
+//________END OF THE DECLARATION__________________________
+
+//results of the functions, so that the calls can't be removed
+static volatile long sink;
+
+int main(int argc, char *argv[]){
+
+   char *optstring = ":T:r:o:b:s:H";
+   int option = 0;
+   int status = 0;
+
+   int minTime = 100;
+   int repetitions = 5;
+   char *output = NULL;
+   char *baselineFile = NULL;
+   double threshold = 10;
+
+   while(((option = getopt(argc, argv, optstring)) != EOF) && status != -1){
+      switch(option){
+         case 'T':
+            minTime = atoi(optarg);
+            break;
+
+         case 'r':
+            repetitions = atoi(optarg);
+            break;
+
+         case 'o':
+            output = optarg;
+            break;
+
+         case 'b':
+            baselineFile = optarg;
+            break;
+
+         case 's':
+            threshold = atof(optarg);
+            break;
+
+         case 'H':
+            printf("AIDE OPTIONS:\n");
+            printf("-T <millisecondes>: durée minimale d'une mesure (100 par défaut).\n");
+            printf("-r <nombre>: mesures de chaque fonction, la plus rapide est gardée (5 par défaut).\n");
+            printf("-o <fichier>: écrit les résultats JSON dans le fichier (sortie standard par défaut).\n");
+            printf("-b <fichier>: compare les résultats à ceux d'un fichier écrit par le programme.\n");
+            printf("-s <pourcentage>: ralentissement toléré par rapport à la référence (10 par défaut).\n");
+            return EXIT_SUCCESS;
+
+         case '?':
+            printf("Option inconnue: %c\n", optopt);
+            status = -1;
+            break;
+
+         case ':':
+            printf("Argument manquant: %c\n", optopt);
+            status = -1;
+            break;
+
+         default:
+            printf("Une erreur inconnue s'est produite\n");
+            status = -1;
+            break;
+      }
+   }
+
+   if(status == -1){
+      printf("Une erreur au niveau des options est survenue!\n");
+      return EXIT_FAILURE;
+   }
+
+   if(minTime < 1 || repetitions < 1 || threshold < 0){
+      printf("Les options choisies sont invalides.\n");
+      return EXIT_FAILURE;
+   }
+
+   Baseline *baseline = NULL;
+   size_t nbBaseline = 0;
+   if(baselineFile != NULL){
+      baseline = read_baseline(baselineFile, &nbBaseline);
+      if(baseline == NULL){
+         printf("Impossible de lire la référence %s\n", baselineFile);
+         return EXIT_FAILURE;
+      }
+   }
+
+   FILE *out = stdout;
+   if(output != NULL){
+      out = fopen(output, "w");
+      if(out == NULL){
+         printf("Impossible d'écrire dans %s\n", output);
+         free(baseline);
+         return EXIT_FAILURE;
+      }
+   }
+
+   const unsigned SIZES[][2] = {{6, 7}, {7, 9}, {20, 20}, {100, 100}};
+   const unsigned NBSIZES = sizeof(SIZES) / sizeof(SIZES[0]);
+
+   const Benchmark BENCHMARKS[] = {
+      {"check_grid_2", NULL, run_check_grid_2},
+      {"check_grid_3", NULL, run_check_grid_3},
+      {"verify_down", verify_down_bench, run_verifier},
+      {"verify_right", verify_right_bench, run_verifier},
+      {"verify_left", verify_left_bench, run_verifier},
+      {"verify_down_right", verify_down_right_bench, run_verifier},
+      {"verify_down_left", verify_down_left_bench, run_verifier},
+      {"verify_up_right", verify_up_right_bench, run_verifier},
+      {"verify_up_left", verify_up_left_bench, run_verifier},
+      {"verify_within_row", verify_within_row_bench, run_verifier},
+      {"verify_within_diagonal_left", verify_within_diagonal_left_bench,
+       run_verifier},
+      {"verify_within_diagonal_right", verify_within_diagonal_right_bench,
+       run_verifier},
+      {"add_token_player", NULL, run_add_token_player},
+      {"add_token_ai", NULL, run_add_token_ai}
+   };
+   const unsigned NBBENCHMARKS = sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0]);
+
+   const int CYCLES = open_cycles();
+   unsigned nbRegressions = 0;
+
+   fprintf(out, "{\n\"cycles\": %s,\n\"benchmarks\": [\n",
+    (CYCLES == -1) ? "false" : "true");
+
+   for(unsigned s = 0; s < NBSIZES && status != -1; ++s){
+      const unsigned NBLINES = SIZES[s][0];
+      const unsigned NBCOLUMNS = SIZES[s][1];
+      char board[NAME_LENGTH];
+      sprintf(board, "%ux%u", NBLINES, NBCOLUMNS);
+
+      //the positions go from a few tokens to two thirds of the grid
+      Position positions[POSITIONS];
+      memset(positions, 0, sizeof(positions));
+      uint64_t state = BENCH_SEED ^ ((uint64_t)NBLINES << 32 | NBCOLUMNS);
+      for(unsigned k = 0; k < POSITIONS && status != -1; ++k){
+         const unsigned NBMOVES = (unsigned)((double)NBLINES * NBCOLUMNS
+          * (0.05 + 0.6 * k / (POSITIONS - 1)));
+         positions[k].mp = play_position(NBLINES, NBCOLUMNS, NBMOVES, &state);
+         positions[k].casesLeft = malloc(sizeof(int) * NBCOLUMNS);
+         if(positions[k].mp == NULL || positions[k].casesLeft == NULL){
+            fprintf(stderr, "Mémoire insuffisante.\n");
+            status = -1;
+         }
+         else{
+            memcpy(positions[k].casesLeft, get_cases_left(positions[k].mp),
+             sizeof(int) * NBCOLUMNS);
+         }
+      }
+
+      for(unsigned n = 0; n < NBBENCHMARKS && status != -1; ++n){
+         double nsPerOp = 0;
+         double cyclesPerOp = -1;
+         unsigned long nbOps = measure(&BENCHMARKS[n], positions,
+          minTime / 1000.0, (unsigned)repetitions, CYCLES, &nsPerOp,
+          &cyclesPerOp);
+
+         fprintf(out, "{\"name\": \"%s\", \"board\": \"%s\", "
+          "\"ns_per_op\": %.3f, \"ops_per_s\": %.0f, ", BENCHMARKS[n].name,
+          board, nsPerOp, 1e9 / nsPerOp);
+         if(cyclesPerOp < 0){
+            fprintf(out, "\"cycles_per_op\": null, ");
+         }
+         else{
+            fprintf(out, "\"cycles_per_op\": %.2f, ", cyclesPerOp);
+         }
+         fprintf(out, "\"ops\": %lu}%s\n", nbOps,
+          (s == NBSIZES - 1 && n == NBBENCHMARKS - 1) ? "" : ",");
+         fflush(out);
+
+         if(baseline != NULL){
+            const Baseline *reference = find_baseline(baseline, nbBaseline,
+             BENCHMARKS[n].name, board);
+            if(reference != NULL && reference->nsPerOp > 0){
+               const double CHANGE = 100 * (nsPerOp / reference->nsPerOp - 1);
+               const int SLOWER = CHANGE > threshold;
+               fprintf(stderr, "%-30s %-8s %10.3f ns (référence %10.3f ns) "
+                "%+7.1f %%%s\n", BENCHMARKS[n].name, board, nsPerOp,
+                reference->nsPerOp, CHANGE, SLOWER ? "  RÉGRESSION" : "");
+               nbRegressions += SLOWER;
+            }
+         }
+      }
+
+      for(unsigned k = 0; k < POSITIONS; ++k){
+         free_model(positions[k].mp);
+         free(positions[k].casesLeft);
+      }
+   }
+
+   fprintf(out, "]\n}\n");
+
+   if(out != stdout){
+      fclose(out);
+   }
+   if(CYCLES != -1){
+      close(CYCLES);
+   }
+   free(baseline);
+
+   if(status == -1){
+      return EXIT_FAILURE;
+   }
+
+   if(nbRegressions > 0){
+      fprintf(stderr, "%u fonction(s) plus lente(s) que la référence de plus "
+       "de %.1f %%\n", nbRegressions, threshold);
+      return EXIT_FAILURE;
+   }
+
+   return EXIT_SUCCESS;
+}
+
+// ----------- STATIC FUNCTIONS --------------------
+
+static Model *play_position(unsigned nbLines, unsigned nbColumns,
+ unsigned nbMoves, uint64_t *state){
+   assert(state != NULL && nbMoves < nbLines * nbColumns);
+
+   Model *mp = create_model(nbLines, nbColumns);
+   if(mp == NULL){
+      return NULL;
+   }
+   //the positions are never searched
+   set_table_size(mp, 0);
+   set_level(mp, easy);
+   set_seed(mp, *state);
+   initialise_game_model(mp, red);
+
+   const int *casesLeft = get_cases_left(mp);
+   int stuck = 0;
+   for(unsigned n = 0; n < nbMoves && !stuck; ++n){
+      //a random column is tried first, then the ones on its right
+      const unsigned START = (unsigned)(next_random(state) % nbColumns);
+      stuck = 1;
+      for(unsigned j = 0; j < nbColumns && stuck; ++j){
+         const unsigned COLUMN = (START + j) % nbColumns;
+         if(casesLeft[COLUMN] < 0){
+            continue;
+         }
+
+         Result result = lose;
+         if(n % 2 == 0){
+            add_token_player(mp, COLUMN, &result);
+         }
+         else{
+            play_token_ai(mp, COLUMN, &result);
+         }
+
+         if(result == win){
+            undo_move(mp);
+         }
+         else{
+            stuck = 0;
+         }
+      }
+   }
+
+   return mp;
+}
+
+static uint64_t next_random(uint64_t *state){
+   assert(state != NULL);
+
+   //splitmix64
+   uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+   z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+   z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+   return z ^ (z >> 31);
+}
+
+static unsigned long run_check_grid_2(const Benchmark *b, Position *p){
+   assert(b != NULL && p != NULL);
+
+   sink += check_grid(p->mp, 2, red, -1);
+   sink += check_grid(p->mp, 2, yellow, -1);
+   return 2;
+}
+
+static unsigned long run_check_grid_3(const Benchmark *b, Position *p){
+   assert(b != NULL && p != NULL);
+
+   sink += check_grid(p->mp, 3, red, -1);
+   sink += check_grid(p->mp, 3, yellow, -1);
+   return 2;
+}
+
+static unsigned long run_verifier(const Benchmark *b, Position *p){
+   assert(b != NULL && b->verifier != NULL && p != NULL);
+
+   const PackedGrid *grid = get_packed_grid(p->mp);
+   const int NBLINES = (int)get_nbLines(p->mp);
+   const int NBCOLUMNS = (int)get_nbColumns(p->mp);
+
+   unsigned long nbCalls = 0;
+   long found = 0;
+   for(int i = 0; i < NBCOLUMNS; ++i){
+      if(p->casesLeft[i] < 0){
+         continue;
+      }
+      for(int range = 2; range <= 3; ++range){
+         found += b->verifier(range, grid, p->casesLeft, red, i, NBLINES,
+          NBCOLUMNS);
+         found += b->verifier(range, grid, p->casesLeft, yellow, i, NBLINES,
+          NBCOLUMNS);
+         nbCalls += 2;
+      }
+   }
+   sink += found;
+
+   return nbCalls;
+}
+
+static unsigned long run_add_token_player(const Benchmark *b, Position *p){
+   assert(b != NULL && p != NULL);
+
+   const unsigned NBCOLUMNS = get_nbColumns(p->mp);
+
+   unsigned long nbCalls = 0;
+   for(unsigned i = 0; i < NBCOLUMNS; ++i){
+      if(p->casesLeft[i] < 0){
+         continue;
+      }
+      Result result = lose;
+      sink += add_token_player(p->mp, i, &result);
+      undo_move(p->mp);
+      ++nbCalls;
+   }
+
+   return nbCalls;
+}
+
+static unsigned long run_add_token_ai(const Benchmark *b, Position *p){
+   assert(b != NULL && p != NULL);
+
+   unsigned column = 0;
+   Result result = lose;
+   sink += add_token_ai(p->mp, &column, &result);
+   undo_move(p->mp);
+
+   return 1;
+}
+
+static int verify_down_bench(int range, const PackedGrid *grid,
+ int *casesLeft, Colour colour, int i, const int NBLINES,
+ const int NBCOLUMNS){
+   (void)NBCOLUMNS;
+   return verify_down(range, grid, casesLeft, colour, i, NBLINES);
+}
+
+static int verify_right_bench(int range, const PackedGrid *grid,
+ int *casesLeft, Colour colour, int i, const int NBLINES,
+ const int NBCOLUMNS){
+   (void)NBLINES;
+   return verify_right(range, grid, casesLeft, colour, i, NBCOLUMNS);
+}
+
+static int verify_left_bench(int range, const PackedGrid *grid,
+ int *casesLeft, Colour colour, int i, const int NBLINES,
+ const int NBCOLUMNS){
+   (void)NBLINES;
+   (void)NBCOLUMNS;
+   return verify_left(range, grid, casesLeft, colour, i);
+}
+
+static int verify_down_right_bench(int range, const PackedGrid *grid,
+ int *casesLeft, Colour colour, int i, const int NBLINES,
+ const int NBCOLUMNS){
+   return verify_down_right(range, grid, casesLeft, colour, i, NBLINES,
+    NBCOLUMNS);
+}
+
+static int verify_down_left_bench(int range, const PackedGrid *grid,
+ int *casesLeft, Colour colour, int i, const int NBLINES,
+ const int NBCOLUMNS){
+   (void)NBCOLUMNS;
+   return verify_down_left(range, grid, casesLeft, colour, i, NBLINES);
+}
+
+static int verify_up_right_bench(int range, const PackedGrid *grid,
+ int *casesLeft, Colour colour, int i, const int NBLINES,
+ const int NBCOLUMNS){
+   (void)NBLINES;
+   return verify_up_right(range, grid, casesLeft, colour, i, NBCOLUMNS);
+}
+
+static int verify_up_left_bench(int range, const PackedGrid *grid,
+ int *casesLeft, Colour colour, int i, const int NBLINES,
+ const int NBCOLUMNS){
+   (void)NBLINES;
+   (void)NBCOLUMNS;
+   return verify_up_left(range, grid, casesLeft, colour, i);
+}
+
+static int verify_within_row_bench(int range, const PackedGrid *grid,
+ int *casesLeft, Colour colour, int i, const int NBLINES,
+ const int NBCOLUMNS){
+   (void)NBLINES;
+   return verify_within_row(range, i, grid, casesLeft, colour, NBCOLUMNS);
+}
+
+static int verify_within_diagonal_left_bench(int range,
+ const PackedGrid *grid, int *casesLeft, Colour colour, int i,
+ const int NBLINES, const int NBCOLUMNS){
+   return verify_within_diagonal_left(range, i, grid, casesLeft, colour,
+    NBLINES, NBCOLUMNS);
+}
+
+static int verify_within_diagonal_right_bench(int range,
+ const PackedGrid *grid, int *casesLeft, Colour colour, int i,
+ const int NBLINES, const int NBCOLUMNS){
+   return verify_within_diagonal_right(range, i, grid, casesLeft, colour,
+    NBLINES, NBCOLUMNS);
+}
+
+static unsigned long measure(const Benchmark *b, Position *positions,
+ double minTime, unsigned repetitions, int cycles, double *nsPerOp,
+ double *cyclesPerOp){
+   assert(b != NULL && positions != NULL && repetitions > 0
+    && nsPerOp != NULL && cyclesPerOp != NULL);
+
+   //the positions are brought into the caches first
+   for(unsigned k = 0; k < POSITIONS; ++k){
+      b->run(b, &positions[k]);
+   }
+
+   unsigned long bestOps = 0;
+   *nsPerOp = -1;
+   *cyclesPerOp = -1;
+   for(unsigned r = 0; r < repetitions; ++r){
+      unsigned long nbOps = 0;
+      double elapsed = 0;
+      start_cycles(cycles);
+      const double START = get_time();
+      do{
+         for(unsigned k = 0; k < POSITIONS; ++k){
+            nbOps += b->run(b, &positions[k]);
+         }
+         elapsed = get_time() - START;
+      }while(elapsed < minTime);
+      const double CYCLES = stop_cycles(cycles);
+
+      const double NS = 1e9 * elapsed / nbOps;
+      if(*nsPerOp < 0 || NS < *nsPerOp){
+         *nsPerOp = NS;
+         *cyclesPerOp = (CYCLES < 0) ? -1 : CYCLES / nbOps;
+         bestOps = nbOps;
+      }
+   }
+
+   return bestOps;
+}
+
+static int open_cycles(void){
+#ifdef __linux__
+   struct perf_event_attr attr;
+   memset(&attr, 0, sizeof(attr));
+   attr.type = PERF_TYPE_HARDWARE;
+   attr.size = sizeof(attr);
+   attr.config = PERF_COUNT_HW_CPU_CYCLES;
+   attr.disabled = 1;
+   attr.exclude_kernel = 1;
+   attr.exclude_hv = 1;
+
+   long fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+   return (fd < 0) ? -1 : (int)fd;
+#else
+   return -1;
+#endif
+}
+
+static void start_cycles(int cycles){
+#ifdef __linux__
+   if(cycles != -1){
+      ioctl(cycles, PERF_EVENT_IOC_RESET, 0);
+      ioctl(cycles, PERF_EVENT_IOC_ENABLE, 0);
+   }
+#else
+   (void)cycles;
+#endif
+}
+
+static double stop_cycles(int cycles){
+#ifdef __linux__
+   if(cycles != -1){
+      ioctl(cycles, PERF_EVENT_IOC_DISABLE, 0);
+      uint64_t count = 0;
+      if(read(cycles, &count, sizeof(count)) == sizeof(count)){
+         return (double)count;
+      }
+   }
+#else
+   (void)cycles;
+#endif
+   return -1;
+}
+
+static Baseline *read_baseline(const char *filename, size_t *nbResults){
+   assert(filename != NULL && nbResults != NULL);
+
+   FILE *file = fopen(filename, "r");
+   if(file == NULL){
+      return NULL;
+   }
+
+   size_t capacity = 64;
+   Baseline *results = malloc(sizeof(Baseline) * capacity);
+   *nbResults = 0;
+
+   //the program writes one benchmark per line
+   char line[512];
+   while(results != NULL && fgets(line, sizeof(line), file) != NULL){
+      Baseline result;
+      if(sscanf(line, " {\"name\": \"%63[^\"]\", \"board\": \"%63[^\"]\", "
+       "\"ns_per_op\": %lf", result.name, result.board,
+       &result.nsPerOp) != 3){
+         continue;
+      }
+
+      if(*nbResults == capacity){
+         capacity *= 2;
+         Baseline *bigger = realloc(results, sizeof(Baseline) * capacity);
+         if(bigger == NULL){
+            free(results);
+            results = NULL;
+            break;
+         }
+         results = bigger;
+      }
+      results[(*nbResults)++] = result;
+   }
+
+   fclose(file);
+   return results;
+}
+
+static const Baseline *find_baseline(const Baseline *baseline,
+ size_t nbResults, const char *name, const char *board){
+   assert(name != NULL && board != NULL);
+
+   for(size_t i = 0; i < nbResults; ++i){
+      if(!strcmp(baseline[i].name, name) && !strcmp(baseline[i].board, board)){
+         return &baseline[i];
+      }
+   }
+
+   return NULL;
+}
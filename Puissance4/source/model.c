@@ -14,12 +14,22 @@
 #include <assert.h>
 #include <time.h>
 #include <string.h>
+#include <stdint.h>
 
 #include "model.h"
 #include "ai.h"
+#include "bitboard.h"
+#include "mcts.h"
+#include "grid.h"
 
 #define MAX_CHAR 50
 #define NB_PLAYERS 10
+//size of the transposition table (in MB) if none is chosen
+#define DEFAULT_TABLE_SIZE 16
+//number of nodes of each arena of the tree of the level montecarlo (16 MB)
+#define MCTS_NODES (1u << 20)
+//seed of the Zobrist keys (the same keys for every game)
+#define ZOBRIST_SEED 0x9E3779B97F4A7C15ULL
 /**
  * @brief Implementation of a User structure
  */
@@ -42,7 +52,12 @@ typedef struct mode_t{
  */
 struct model_t{
    char *highscoresFile;
+   //cells of the grid, 2 bits each (see grid.h)
+   PackedGrid *grid;
+   //copy of the grid given by get_grid(), NULL until asked for
    Colour **gameGrid;
+   //key of the position in gameGrid (rebuilt if it isn't hash)
+   uint64_t gameGridHash;
    int* casesLeft;
    unsigned int nbLines;
    unsigned int nbColumns;
@@ -50,6 +65,64 @@ struct model_t{
    User prevPlayers[NB_PLAYERS];
    Colour machineColour;
    Mode mode;
+   //colour of the first token of the game and number of tokens placed
+   Colour firstColour;
+   unsigned nbMoves;
+   //columns of the tokens placed, in order (nbMoves of them)
+   unsigned *history;
+   /* columns of the moves taken back by undo_move(), the last one first
+    * (nbRedos of them) */
+   unsigned *redos;
+   unsigned nbRedos;
+   Level level;
+   unsigned searchDepth;
+   //time given to the search for each move (in ms), 0 for a fixed depth
+   unsigned moveTime;
+   SearchInfo lastSearch;
+   unsigned nbWords;
+   //one bitboard per colour (tokens[none] isn't used)
+   uint64_t *tokens[3];
+   //bit of the lowest empty cell of each column (extra bit if it is full)
+   uint64_t *heightMask;
+   //bits of all the cells of the grid
+   uint64_t *boardMask;
+   //two Zobrist keys (red and yellow) per bit of the bitboards
+   uint64_t *zobristKeys;
+   uint64_t hash;
+   TranspositionTable *table;
+   //NULL if the computer has no opening book
+   OpeningBook *book;
+   //a copy shares the table and the book of its model and doesn't free them
+   Boolean isCopy;
+   //number of threads of the search
+   unsigned nbThreads;
+   //flag set by another thread to stop the search, NULL if there isn't any
+   int *stopFlag;
+   //state of the random numbers of the model (see next_key())
+   uint64_t random;
+   //tree of the level montecarlo (shared by the copies), NULL until needed
+   Mcts *mcts;
+   /* level of threat of each empty cell for red and yellow (see
+    * compute_threat()), index 2 * (row * nbColumns + column) + (colour == yellow) */
+   uint8_t *threats;
+   /* the threats describe the position after the first threatsMoves moves
+    * of history, the next ones are added when the threats are needed */
+   unsigned threatsMoves;
+   //number of windows of four cells in a row of the grid
+   unsigned nbWindows;
+   /* windows of each cell: cellWindows[windowStart[cell]] to
+    * cellWindows[windowStart[cell + 1] - 1] (cell = row * nbColumns + column),
+    * shared by the copies */
+   uint32_t *windowStart;
+   uint32_t *cellWindows;
+   //tokens of each window, index 2 * window + (colour == yellow)
+   uint8_t *windowCounts;
+   //windows holding k tokens of a colour and none of the other one
+   unsigned openWindows[2][5];
+   //copy of the grid in one block, with margins (see get_cells())
+   uint8_t *cells;
+   //key of the position in cells (rebuilt if it isn't hash)
+   uint64_t cellsHash;
 };
 
 //_________DECLARATION OF THE STATIC FUNCTION_____________
@@ -57,40 +130,265 @@ struct model_t{
 /**
  * @brief Picks randomly a number from 0 to upperLimit (not included)
  * 
+ * @param mp pointer on the model (for its random numbers).
  * @param upperLimit The upper limit of the interval
  * 
- * @pre upperLimit > 0
+ * @pre mp != NULL, upperLimit > 0
  * @post returns a number within the interval
  */
-static int random_number(int upperLimit);
+static int random_number(Model *mp, int upperLimit);
+
+/**
+ * @brief Places a token in a column and updates the grid, the bitboards,
+ *  the heights, the windows and the threats
+ *
+ * @param mp pointer on the model.
+ * @param column index of the column.
+ * @param colour colour of the token.
+ *
+ * @pre mp != NULL, the column isn't full
+ * @post returns the position of the row the token has been placed in.
+ */
+static unsigned place_token(Model *mp, unsigned column, Colour colour);
+
+/**
+ * @brief Looks with the bitboards for a column where a token would align
+ *  four tokens of a colour
+ *
+ * @param mp pointer on the model.
+ * @param colour colour of the tokens.
+ * @param specificColumn the index of the column we want to check (a negative
+ * number if we want to check all of them).
+ *
+ * @pre mp != NULL, colour == red || colour == yellow
+ * @post returns the index of the first column found, -1 if there isn't any.
+ */
+static int find_winning_column(Model *mp, Colour colour, int specificColumn);
+
+/**
+ * @brief Computes the level of threat of an empty cell for a colour
+ *
+ * @remark Along each line through the cell, the tokens of the colour touching
+ * it are counted on both sides (3 at most). The level is the highest sum: 3
+ * means that a token there aligns four tokens, 2 that it aligns three (the
+ * patterns of check_grid() with a range of 3 and 2).
+ *
+ * @param mp pointer on the model.
+ * @param row index of the row of the cell.
+ * @param column index of the column of the cell.
+ * @param colour colour of the tokens.
+ *
+ * @pre mp != NULL, the cell is in the grid, colour == red || colour == yellow
+ * @post returns the level (from 0 to 3).
+ */
+static unsigned compute_threat(Model *mp, int row, int column, Colour colour);
+
+/**
+ * @brief Updates the threats after a token has been placed on a cell or
+ *  removed from it
+ *
+ * @remark Besides the cell itself, only the first empty cell after the tokens
+ * of the same colour in each direction (at most 3 cells away) can change, and
+ * only for that colour: at most 9 cells are computed again.
+ *
+ * @param mp pointer on the model.
+ * @param row index of the row of the cell.
+ * @param column index of the column of the cell.
+ * @param colour colour of the token placed or removed.
+ *
+ * @pre mp != NULL, colour == red || colour == yellow, the grid is already the
+ * one after the move
+ * @post the threats of the cells whose lines go through the cell are the ones
+ * of the grid.
+ */
+static void update_threats(Model *mp, unsigned row, unsigned column,
+ Colour colour);
+
+/**
+ * @brief Adds to the threats the moves played since they were last updated
+ *
+ * @param mp pointer on the model.
+ *
+ * @pre mp != NULL
+ * @post the threats describe the position (threatsMoves == nbMoves).
+ */
+static void catch_up_threats(Model *mp);
+
+/**
+ * @brief Looks for the first column whose lowest empty cell has a level of
+ *  threat for a colour (the threats are updated first if needed)
+ *
+ * @param mp pointer on the model.
+ * @param level lowest level accepted (3 to align four tokens, 2 for three).
+ * @param colour colour of the tokens.
+ *
+ * @pre mp != NULL, colour == red || colour == yellow
+ * @post returns the index of the column, -1 if there isn't any.
+ */
+static int find_threat_column(Model *mp, unsigned level, Colour colour);
+
+/**
+ * @brief Counts the windows of four cells in a row of a grid
+ *
+ * @param nbLines Number of lines of the grid
+ * @param nbColumns Number of columns of the grid
+ *
+ * @pre /
+ * @post returns the number of windows (horizontal, vertical and diagonal).
+ */
+static unsigned count_windows(unsigned nbLines, unsigned nbColumns);
+
+/**
+ * @brief Builds the tables giving the windows each cell belongs to
+ *
+ * @param mp pointer on the model.
+ *
+ * @pre mp != NULL, mp->nbWindows is set
+ * @post returns 1 if the tables are built, -1 if something went wrong.
+ */
+static int create_windows(Model *mp);
+
+/**
+ * @brief Adds a token to the counters of the windows of its cell
+ *
+ * @param mp pointer on the model.
+ * @param cell index of the cell (row * nbColumns + column).
+ * @param colour colour of the token.
+ *
+ * @pre mp != NULL, colour == red || colour == yellow
+ * @post the counters and the open windows are updated.
+ */
+static void add_to_windows(Model *mp, unsigned cell, Colour colour);
+
+/**
+ * @brief Removes a token from the counters of the windows of its cell
+ *
+ * @param mp pointer on the model.
+ * @param cell index of the cell (row * nbColumns + column).
+ * @param colour colour of the token.
+ *
+ * @pre mp != NULL, colour == red || colour == yellow, the token was added
+ * @post the counters and the open windows are updated.
+ */
+static void remove_from_windows(Model *mp, unsigned cell, Colour colour);
+
+/**
+ * @brief Gives the next number of a pseudo-random sequence (splitmix64)
+ *
+ * @param state pointer on the state of the sequence.
+ *
+ * @pre state != NULL
+ * @post the state is updated and the number returned.
+ */
+static uint64_t next_key(uint64_t *state);
+
+/**
+ * @brief Allocates a model and the data depending on the size of the grid
+ *  (without the transposition table)
+ *
+ * @param nbLines Number of lines of the grid
+ * @param nbColumns Number of columns of the grid
+ *
+ * @pre nbLines > 0, nbColumns > 0
+ * @post Returns the address of the model (not initialised), NULL if
+ * something went wrong.
+ */
+static Model *allocate_model(unsigned nbLines, unsigned nbColumns);
+
+/**
+ * @brief Turns a model into a copy of another one of the same size
+ *
+ * @param copy pointer on the model receiving the copy.
+ * @param mp pointer on the model copied.
+ *
+ * @pre copy != NULL, mp != NULL, the grids have the same size, copy doesn't
+ * own a table, a book or a tree (see clone_model())
+ * @post copy has the position and the settings of mp, shares what mp shares
+ * with its copies and keeps its own blocks of memory.
+ */
+static void copy_model(Model *copy, Model *mp);
+
+/**
+ * @brief Copies the position of a model into another one of the same size
+ *
+ * @param destination pointer on the model receiving the position.
+ * @param source pointer on the model copied.
+ *
+ * @pre destination != NULL, source != NULL, the grids have the same size
+ * @post destination has the tokens, the colours, the key, the threats and
+ * the counts of the windows of source, its copies of the grid (Colour, cells)
+ * are rebuilt when they are needed. Nothing is allocated.
+ */
+static void copy_position(Model *destination, Model *source);
+
+/**
+ * @brief Chooses the column of the computer with the heuristic of the level
+ *  easy (opening book, win, block, add a third token, prevent a third token,
+ *  random)
+ *
+ * @param mp pointer on the model.
+ *
+ * @pre mp != NULL, the grid isn't full
+ * @post returns the index of the column chosen.
+ */
+static unsigned heuristic_column(Model *mp);
+
+/**
+ * @brief Chooses the column of the computer with a search of the game tree
+ *  (level hard), within the time given or at the default depth
+ *
+ * @param mp pointer on the model.
+ *
+ * @pre mp != NULL, the grid isn't full
+ * @post returns the index of the column chosen (by the heuristic if the
+ * search couldn't be done).
+ */
+static unsigned search_column(Model *mp);
+
+/**
+ * @brief Chooses the column of the computer with a Monte Carlo tree search
+ *  (level montecarlo), within the time given or for a fixed number of games
+ *
+ * @param mp pointer on the model.
+ *
+ * @pre mp != NULL, the grid isn't full
+ * @post returns the index of the column chosen (by the heuristic if the
+ * search couldn't be done).
+ */
+static unsigned mcts_column(Model *mp);
 
 //________END OF THE DECLARATION__________________________ 
 
 Model *create_model(unsigned nbLines, unsigned nbColumns){
 
-   Model* mp = malloc(sizeof(Model));
+   Model* mp = allocate_model(nbLines, nbColumns);
    if(mp == NULL){
       return NULL;
    }
 
-   mp->gameGrid = create_game_grid(nbLines, nbColumns);
-   if(mp->gameGrid == NULL){
-      free(mp);
-      return NULL;
-   }
+   mp->book = NULL;
+   mp->mcts = NULL;
+   mp->isCopy = false;
 
-   mp->casesLeft = malloc(sizeof(int) * nbColumns);
-   if(mp->casesLeft == NULL){
-      free_game_grid(mp->gameGrid, nbLines);
-      free(mp);
+   //the windows never change: they are built once, the copies share them
+   if(create_windows(mp) == -1){
+      free_model(mp);
       return NULL;
    }
 
-   mp->nbLines = nbLines;
-   mp->nbColumns = nbColumns;
+   //without a table the search still works, only slower
+   mp->table = create_table(DEFAULT_TABLE_SIZE);
+
    mp->highscoresFile = NULL;
    mp->player.present = false;
    mp->mode.isBreakfast = false;
+   mp->level = easy;
+   mp->searchDepth = get_default_depth(nbLines, nbColumns);
+   mp->moveTime = 0;
+   mp->nbThreads = 1;
+   mp->stopFlag = NULL;
+   //two models created in the same second don't draw the same numbers
+   mp->random = (uint64_t)time(NULL) ^ (uint64_t)(uintptr_t)mp;
 
    /* we call this fonction in here in case it is not called in the main
     *  at the beginning */
@@ -99,38 +397,68 @@ Model *create_model(unsigned nbLines, unsigned nbColumns){
    return mp;
 }
 
+Model *duplicate_model(Model *mp){
+   assert(mp != NULL);
+
+   Model *copy = allocate_model(mp->nbLines, mp->nbColumns);
+   if(copy == NULL){
+      return NULL;
+   }
+
+   copy->gameGrid = NULL;
+   copy_model(copy, mp);
+
+   return copy;
+}
+
+int clone_model(Model *slot, Model *mp){
+   assert(slot != NULL && mp != NULL && slot != mp);
+
+   //a model that isn't a copy owns its table, its book and its tree
+   if(!slot->isCopy || slot->nbLines != mp->nbLines
+    || slot->nbColumns != mp->nbColumns){
+      return -1;
+   }
+
+   copy_model(slot, mp);
+
+   return 1;
+}
+
+int restore_model(Model *mp, Model *snapshot){
+   assert(mp != NULL && snapshot != NULL && mp != snapshot);
+
+   if(mp->nbLines != snapshot->nbLines || mp->nbColumns != snapshot->nbColumns){
+      return -1;
+   }
+
+   copy_position(mp, snapshot);
+   mp->nbRedos = 0;
+
+   return 1;
+}
+
 Colour **create_game_grid(unsigned nbLines, unsigned nbColumns){
    assert(nbLines > 0 &&  nbColumns > 0);
 
-   Colour **grid = malloc(sizeof(Colour *) * nbLines);
+   //the pointers on the lines are followed by the cells
+   Colour **grid = malloc(sizeof(Colour *) * nbLines
+    + sizeof(Colour) * nbLines * nbColumns);
    if(grid == NULL){
       return NULL;
    }
 
-   int stop = 0;
-   for(unsigned i = 0; i < nbLines && !stop; ++i){
-      grid[i] = malloc(sizeof(Colour) * nbColumns);
-      if(grid[i] == NULL){
-         free_game_grid(grid, nbLines);
-         stop = 1;
-      }
-   }
-   if(stop == 1){
-      return NULL;
+   Colour *cells = (Colour *)(grid + nbLines);
+   for(unsigned i = 0; i < nbLines; ++i){
+      grid[i] = cells + i * nbColumns;
    }
 
    return grid;
 }
 
 void free_game_grid(Colour **gameGrid, unsigned nbLines){
-   if(gameGrid == NULL){
-      return;
-   }
-   for(unsigned i = 0; i < nbLines; ++i){
-      if(gameGrid[i] != NULL){
-         free(gameGrid[i]);
-      }
-   }
+   //the grid is one block of memory
+   (void)nbLines;
    free(gameGrid);
 }
 
@@ -143,7 +471,7 @@ void initialise_game_model(Model *mp, Colour choice){
 
    //If the colour given doesn't exist, we pick one randomly
    if(choice != red && choice != yellow){
-      choice = random_number(2);
+      choice = random_number(mp, 2);
    }
 
    switch(choice){
@@ -164,23 +492,68 @@ void initialise_game_model(Model *mp, Colour choice){
       break;
    }
 
-   for(unsigned i = 0; i < mp->nbLines; ++i){
-      for(unsigned j = 0; j < mp->nbColumns; ++j){
-         mp->gameGrid[i][j] = none;
-      }
+   //the player always starts the game
+   mp->firstColour = mp->player.colour;
+   mp->nbMoves = 0;
+   mp->nbRedos = 0;
+   mp->hash = 0;
+   if(mp->table != NULL){
+      clear_table(mp->table);
    }
+   if(mp->mcts != NULL){
+      clear_mcts(mp->mcts);
+   }
+   mp->lastSearch.column = -1;
+   mp->lastSearch.score = 0;
+   mp->lastSearch.depth = 0;
+   mp->lastSearch.nodes = 0;
+   mp->lastSearch.seconds = 0;
+
+   clear_packed_grid(mp->grid);
 
    for(unsigned i = 0; i < mp->nbColumns; ++i){
       mp->casesLeft[i] = (int)mp->nbLines - 1;
    }
+
+   //nothing threatens an empty grid
+   memset(mp->threats, 0, sizeof(uint8_t) * 2 * mp->nbLines * mp->nbColumns);
+   mp->threatsMoves = 0;
+
+   memset(mp->windowCounts, 0, sizeof(uint8_t) * 2 * mp->nbWindows);
+
+   //every window is empty, thus open for both colours
+   memset(mp->openWindows, 0, sizeof(mp->openWindows));
+   mp->openWindows[0][0] = mp->nbWindows;
+   mp->openWindows[1][0] = mp->nbWindows;
+
+   clear_bitboard(mp->tokens[red], mp->nbWords);
+   clear_bitboard(mp->tokens[yellow], mp->nbWords);
+   clear_bitboard(mp->heightMask, mp->nbWords);
+   for(unsigned i = 0; i < mp->nbColumns; ++i){
+      set_bit(mp->heightMask, get_bit_index(mp->nbLines, mp->nbLines - 1, i));
+   }
 }
 
 void free_model(Model *mp){
    if(mp == NULL){
       return;
    }
+   free_packed_grid(mp->grid);
    free_game_grid(mp->gameGrid, mp->nbLines);
    free(mp->casesLeft);
+   free(mp->boardMask);
+   free(mp->zobristKeys);
+   free(mp->threats);
+   free(mp->windowCounts);
+   free(mp->cells);
+   free(mp->history);
+   if(!mp->isCopy){
+      free(mp->windowStart);
+      free(mp->cellWindows);
+      free_table(mp->table);
+      close_book(mp->book);
+      free_mcts(mp->mcts);
+   }
    free(mp);
 }
 
@@ -190,6 +563,11 @@ int check_grid(Model* mp, int range, Colour colour, int specificColumn){
    const int NBCOLUMNS = (int)mp->nbColumns;
    const int NBLINES = (int)mp->nbLines;
 
+   //completing a Connect 4 is directly checked on the bitboards
+   if(range == 3 && (colour == red || colour == yellow)){
+      return find_winning_column(mp, colour, specificColumn);
+   }
+
    int status = -1;
    int stop = 0;
    int i = 0;
@@ -211,41 +589,41 @@ int check_grid(Model* mp, int range, Colour colour, int specificColumn){
       }
       else{
          //checking the tokens to the left
-         status = verify_left(range, mp->gameGrid, mp->casesLeft, colour, i);
+         status = verify_left(range, mp->grid, mp->casesLeft, colour, i);
 
          if(status == -1){
             //checking the tokens in oblique to the top left
-            status = verify_up_left(range, mp->gameGrid, mp->casesLeft, colour,
+            status = verify_up_left(range, mp->grid, mp->casesLeft, colour,
              i);
          }
 
          if(status == -1){
             //checking the tokens in oblique to the bottom left
-            status = verify_down_left(range, mp->gameGrid, mp->casesLeft,
+            status = verify_down_left(range, mp->grid, mp->casesLeft,
              colour, i, NBLINES);
          }
 
          if(status == -1){
             //checking the tokens to the right
-            status = verify_right(range, mp->gameGrid, mp->casesLeft, colour,
+            status = verify_right(range, mp->grid, mp->casesLeft, colour,
              i, NBCOLUMNS);
          }
 
          if(status == -1){
             //checking the tokens in oblique to the top right
-            status = verify_up_right(range, mp->gameGrid, mp->casesLeft,
+            status = verify_up_right(range, mp->grid, mp->casesLeft,
              colour, i, NBCOLUMNS);
          }
 
          if(status == -1){
             //checking the tokens in oblique to the bottom right
-            status = verify_down_right(range, mp->gameGrid, mp->casesLeft,
+            status = verify_down_right(range, mp->grid, mp->casesLeft,
              colour, i, NBLINES, NBCOLUMNS);
          }
 
          if(status == -1){
             //checking the tokens underneath
-            status = verify_down(range, mp->gameGrid, mp->casesLeft, colour,
+            status = verify_down(range, mp->grid, mp->casesLeft, colour,
              i, NBLINES);
          }
 
@@ -254,7 +632,7 @@ int check_grid(Model* mp, int range, Colour colour, int specificColumn){
             /* will allow to check all the posibilities according to the position
              * (here the possibilities for a row) 
              */
-            status = verify_within_row(range, i, mp->gameGrid, mp->casesLeft, colour,
+            status = verify_within_row(range, i, mp->grid, mp->casesLeft, colour,
              NBCOLUMNS);
          }
 
@@ -262,14 +640,14 @@ int check_grid(Model* mp, int range, Colour colour, int specificColumn){
             /* will allow to check all the posibilities according to the position
              * (here the possibilities for a diagonal with a negative slope) 
              */
-            status = verify_within_diagonal_left(range, i, mp->gameGrid,
+            status = verify_within_diagonal_left(range, i, mp->grid,
              mp->casesLeft, colour, NBLINES, NBCOLUMNS);
          }
          if(status == -1){
                /* will allow to check all the posibilities according to the position
                * (here the possibilities for a diagonal with a positive slope) 
                */
-            status = verify_within_diagonal_right(range, i, mp->gameGrid,
+            status = verify_within_diagonal_right(range, i, mp->grid,
              mp->casesLeft, colour, NBLINES, NBCOLUMNS);
          }
 
@@ -279,26 +657,60 @@ int check_grid(Model* mp, int range, Colour colour, int specificColumn){
    return status;
 }
 
+int check_alignment(Model *mp, unsigned rowPosition, unsigned columnPosition){
+   assert(mp != NULL && rowPosition < mp->nbLines
+    && columnPosition < mp->nbColumns);
+
+   Colour colour = get_packed_cell(mp->grid, rowPosition, columnPosition);
+   if(colour != red && colour != yellow){
+      return 0;
+   }
+
+   //a window of the cell holds four tokens of its colour
+   const unsigned CELL = rowPosition * mp->nbColumns + columnPosition;
+   for(uint32_t i = mp->windowStart[CELL]; i < mp->windowStart[CELL + 1]; ++i){
+      if(mp->windowCounts[2 * mp->cellWindows[i] + (colour == yellow)] == 4){
+         return 1;
+      }
+   }
+   return 0;
+}
+
+int evaluate_windows(Model *mp, Colour colour){
+   assert(mp != NULL && (colour == red || colour == yellow));
+
+   //a token more in an open window is worth four times as much
+   const int WEIGHTS[4] = {0, 1, 4, 16};
+   const unsigned OWN = (colour == yellow);
+
+   int score = 0;
+   for(unsigned k = 1; k < 4; ++k){
+      score += WEIGHTS[k] * ((int)mp->openWindows[OWN][k]
+       - (int)mp->openWindows[1 - OWN][k]);
+   }
+   return score;
+}
+
 unsigned add_token_player(Model *mp, unsigned columnPosition, Result *result){
    assert(mp != NULL);
 
-   //Checking if the player will win the game with this move
-   int status = check_grid(mp, 3, mp->player.colour, columnPosition);
+   //The game grid will be filled according to the position of the token
+   uint64_t previousHash = mp->hash;
+   unsigned rowPosition = place_token(mp, columnPosition, mp->player.colour);
+   if(mp->mcts != NULL && !mp->isCopy){
+      play_mcts_move(mp->mcts, previousHash, columnPosition, mp->hash);
+   }
 
-   //if the status is != -1, it means the spot selected did a Connect 4 
-   if(status != -1){
+   //Checking if the player won the game with this move
+   if(check_alignment(mp, rowPosition, columnPosition)){
       *result = win;
    }
 
-   unsigned rowPosition = (unsigned)mp->casesLeft[columnPosition];
-   //The game grid will be filled according to the position of the token
-   mp->gameGrid[rowPosition][columnPosition] = mp->player.colour;
-
    //The players score increase after placing a token
    ++mp->player.score;
 
-   //The pile of tokens in that column increases
-   --mp->casesLeft[columnPosition];
+   //the moves taken back can't be played again anymore
+   mp->nbRedos = 0;
 
    return rowPosition;
 }
@@ -306,56 +718,201 @@ unsigned add_token_player(Model *mp, unsigned columnPosition, Result *result){
 unsigned add_token_ai(Model *mp, unsigned* columnPosition, Result *result){
    assert(mp != NULL);
 
-   *result = win;
-   int colTemp = 0;
-   int everyColumn = -1;
+   *columnPosition = heuristic_column(mp);
 
-   //Step 1: Check victory for the computer
-   colTemp = check_grid(mp, 3, mp->machineColour, everyColumn);
+   return play_token_ai(mp, *columnPosition, result);
+}
 
-   //Step 2: Prevent player from winning (if not step 1)
-   if(colTemp == -1){
-      *result = lose;
-      colTemp = check_grid(mp, 3, mp->player.colour, everyColumn);
+unsigned add_token_ai_search(Model *mp, unsigned *columnPosition,
+ Result *result){
+   assert(mp != NULL);
+
+   *columnPosition = search_column(mp);
+
+   return play_token_ai(mp, *columnPosition, result);
+}
+
+unsigned add_token_ai_mcts(Model *mp, unsigned *columnPosition,
+ Result *result){
+   assert(mp != NULL);
+
+   *columnPosition = mcts_column(mp);
+
+   return play_token_ai(mp, *columnPosition, result);
+}
+
+unsigned choose_column_ai(Model *mp){
+   assert(mp != NULL);
+
+   if(mp->level == easy){
+      return heuristic_column(mp);
+   }
+   if(mp->level == montecarlo){
+      return mcts_column(mp);
    }
+   return search_column(mp);
+}
 
-   //Step 3: Add a third token (if not steps 1 & 2)
-   if(colTemp == -1){
-      *result = lose;
-      colTemp = check_grid(mp, 2, mp->machineColour, everyColumn);
+unsigned play_token_ai(Model *mp, unsigned columnPosition, Result *result){
+   assert(mp != NULL && result != NULL);
+
+   uint64_t previousHash = mp->hash;
+   unsigned rowPosition = place_token(mp, columnPosition, mp->machineColour);
+   if(mp->mcts != NULL && !mp->isCopy){
+      play_mcts_move(mp->mcts, previousHash, columnPosition, mp->hash);
    }
 
-   //Step 4: Prevent a third token to be added (if not steps 1, 2 & 3)
-   if(colTemp == -1){
+   //Checking if the computer won the game with this move
+   if(check_alignment(mp, rowPosition, columnPosition)){
+      *result = win;
+   }
+   else{
       *result = lose;
-      colTemp = check_grid(mp, 2, mp->player.colour, everyColumn);
    }
 
-   //Step 5: Choose a random column to add a token (last option)
-   if(colTemp == -1){
-      *result = lose;
-      colTemp = random_number(mp->nbColumns);
-      //if the column chosen is full, we take the next one that isn't
-      while(mp->casesLeft[colTemp] < 0){
-         colTemp = (colTemp + 1) % mp->nbColumns;
+   mp->nbRedos = 0;
+
+   return rowPosition;
+}
+
+unsigned make_move(Model *mp, unsigned column){
+   assert(mp != NULL);
+
+   return place_token(mp, column, get_side_to_move(mp));
+}
+
+void unmake_move(Model *mp, unsigned column){
+   assert(mp != NULL && column < mp->nbColumns && mp->nbMoves > 0
+    && mp->history[mp->nbMoves - 1] == column);
+
+   unsigned row = (unsigned)(mp->casesLeft[column] + 1);
+   unsigned index = get_bit_index(mp->nbLines, row, column);
+
+   Colour colour = get_packed_cell(mp->grid, row, column);
+   reset_bit(mp->tokens[colour], index);
+   remove_from_windows(mp, row * mp->nbColumns + column, colour);
+   mp->hash ^= mp->zobristKeys[2 * index + (colour == yellow)];
+   set_packed_cell(mp->grid, row, column, none);
+
+   //a move not added to the threats yet (a search) doesn't change them
+   if(mp->threatsMoves == mp->nbMoves){
+      update_threats(mp, row, column, colour);
+      --mp->threatsMoves;
+   }
+
+   //the removed cell is the lowest empty one of the column again
+   reset_bit(mp->heightMask, index + 1);
+   set_bit(mp->heightMask, index);
+
+   ++mp->casesLeft[column];
+   --mp->nbMoves;
+}
+
+int undo_move(Model *mp){
+   assert(mp != NULL);
+
+   if(mp->nbMoves == 0){
+      return -1;
+   }
+
+   unsigned column = mp->history[mp->nbMoves - 1];
+   unsigned row = (unsigned)(mp->casesLeft[column] + 1);
+   Colour colour = get_packed_cell(mp->grid, row, column);
+
+   /* the tree of the level montecarlo is rebuilt when it is needed (its key
+    * isn't the one of the position anymore) */
+   unmake_move(mp, column);
+
+   if(colour == mp->player.colour){
+      --mp->player.score;
+   }
+   mp->redos[mp->nbRedos++] = column;
+
+   return (int)column;
+}
+
+int redo_move(Model *mp){
+   assert(mp != NULL);
+
+   if(mp->nbRedos == 0){
+      return -1;
+   }
+
+   unsigned column = mp->redos[--mp->nbRedos];
+   Colour colour = get_side_to_move(mp);
+
+   uint64_t previousHash = mp->hash;
+   place_token(mp, column, colour);
+   if(mp->mcts != NULL && !mp->isCopy){
+      play_mcts_move(mp->mcts, previousHash, column, mp->hash);
+   }
+
+   if(colour == mp->player.colour){
+      ++mp->player.score;
+   }
+
+   return (int)column;
+}
+
+int play_moves(Model *mp, const char *moves){
+   assert(mp != NULL && moves != NULL);
+
+   unsigned nbPlayed = 0;
+   int won = 0;
+   int status = 1;
+   const char *c = moves;
+   while(*c != '\0' && status == 1){
+      if(*c < '0' || *c > '9'){
+         ++c;
+         continue;
+      }
+
+      unsigned column = 0;
+      if(mp->nbColumns <= 9){
+         column = (unsigned)(*c++ - '0');
+      }
+      else{
+         //the number only has to be known while it can be a column
+         while(*c >= '0' && *c <= '9'){
+            if(column <= mp->nbColumns){
+               column = 10 * column + (unsigned)(*c - '0');
+            }
+            ++c;
+         }
+      }
+
+      if(won || column == 0 || column > mp->nbColumns
+       || mp->casesLeft[column - 1] < 0){
+         status = -1;
+      }
+      else{
+         unsigned row = make_move(mp, column - 1);
+         won = check_alignment(mp, row, column - 1);
+         ++nbPlayed;
       }
    }
 
-   //colTemp represents the column chosen by the computer now
-   *columnPosition = (unsigned)colTemp;
+   if(status == -1){
+      for(; nbPlayed > 0; --nbPlayed){
+         unmake_move(mp, mp->history[mp->nbMoves - 1]);
+      }
+      return -1;
+   }
 
-   unsigned rowPosition = (unsigned)mp->casesLeft[*columnPosition];
+   //the moves taken back before belong to another game
+   if(nbPlayed > 0){
+      mp->nbRedos = 0;
+   }
 
-   mp->gameGrid[rowPosition][*columnPosition] = mp->machineColour;
-   --mp->casesLeft[*columnPosition];
-   return rowPosition;
+   return (int)nbPlayed;
 }
 
 int check_height(Model *mp, unsigned columnChosen){
    assert(mp != NULL);
 
+   //the bit of a full column is the extra bit above the grid
    if(columnChosen < mp->nbColumns)
-      if(mp->casesLeft[columnChosen] < 0)
+      if(test_bit(mp->heightMask, columnChosen * (mp->nbLines + 1) + mp->nbLines))
          return 1;
 
    return 0;
@@ -375,34 +932,204 @@ void set_highscores_file(Model *mp, char *highscoresFile){
    mp->highscoresFile = highscoresFile;
 }
 
-//------------ getters functions ------------------
+int set_table_size(Model *mp, unsigned megabytes){
+   assert(mp != NULL);
 
-unsigned int get_nbLines(Model* mp){
+   free_table(mp->table);
+   mp->table = NULL;
+
+   if(megabytes == 0){
+      return 1;
+   }
+
+   mp->table = create_table(megabytes);
+   if(mp->table == NULL){
+      return -1;
+   }
+   return 1;
+}
+
+int set_book(Model *mp, const char *filename){
    assert(mp != NULL);
-   return mp->nbLines;
+
+   close_book(mp->book);
+   mp->book = NULL;
+
+   if(filename == NULL){
+      return 1;
+   }
+
+   mp->book = open_book(filename);
+   if(mp->book == NULL){
+      return -1;
+   }
+   if(get_book_nbLines(mp->book) != mp->nbLines
+    || get_book_nbColumns(mp->book) != mp->nbColumns){
+      close_book(mp->book);
+      mp->book = NULL;
+      return -1;
+   }
+   return 1;
 }
 
-unsigned int get_nbColumns(Model* mp){
+void set_move_time(Model *mp, unsigned milliseconds){
    assert(mp != NULL);
-   return mp->nbColumns;
+   mp->moveTime = milliseconds;
 }
 
-Colour get_player_colour(Model* mp){
+void set_level(Model *mp, Level level){
    assert(mp != NULL);
-   return mp->player.colour;
+   mp->level = level;
+
+   //the tree is only allocated for the level using it
+   if(level == montecarlo && mp->mcts == NULL && !mp->isCopy){
+      mp->mcts = create_mcts(MCTS_NODES);
+   }
 }
 
-Colour get_ai_colour(Model* mp){
+void set_nb_threads(Model *mp, unsigned nbThreads){
+   assert(mp != NULL && nbThreads > 0);
+   mp->nbThreads = nbThreads;
+}
+
+void set_stop_flag(Model *mp, int *stop){
    assert(mp != NULL);
-   return mp->machineColour;
+   mp->stopFlag = stop;
 }
 
-char *get_curr_player_name(Model *mp){
+void set_seed(Model *mp, uint64_t seed){
    assert(mp != NULL);
-   if(!mp->player.present){
-      return NULL;
-   }
-   return mp->player.name;
+   mp->random = seed;
+}
+
+int set_first_colour(Model *mp, Colour colour){
+   assert(mp != NULL);
+
+   if(mp->nbMoves > 0 || (colour != red && colour != yellow)){
+      return -1;
+   }
+   mp->firstColour = colour;
+
+   return 1;
+}
+
+//------------ getters functions ------------------
+
+unsigned int get_nbLines(Model* mp){
+   assert(mp != NULL);
+   return mp->nbLines;
+}
+
+unsigned int get_nbColumns(Model* mp){
+   assert(mp != NULL);
+   return mp->nbColumns;
+}
+
+Colour get_player_colour(Model* mp){
+   assert(mp != NULL);
+   return mp->player.colour;
+}
+
+Colour get_ai_colour(Model* mp){
+   assert(mp != NULL);
+   return mp->machineColour;
+}
+
+Colour get_side_to_move(Model *mp){
+   assert(mp != NULL);
+
+   if(mp->nbMoves % 2 == 0){
+      return mp->firstColour;
+   }
+   return (mp->firstColour == red) ? yellow : red;
+}
+
+unsigned get_nb_moves(Model *mp){
+   assert(mp != NULL);
+   return mp->nbMoves;
+}
+
+unsigned get_move(Model *mp, unsigned rank){
+   assert(mp != NULL && rank < mp->nbMoves);
+   return mp->history[rank];
+}
+
+uint64_t get_hash(Model *mp){
+   assert(mp != NULL);
+   return mp->hash;
+}
+
+TranspositionTable *get_table(Model *mp){
+   assert(mp != NULL);
+   return mp->table;
+}
+
+Boolean is_copy(Model *mp){
+   assert(mp != NULL);
+   return mp->isCopy;
+}
+
+OpeningBook *get_book(Model *mp){
+   assert(mp != NULL);
+   return mp->book;
+}
+
+uint64_t get_book_key(Model *mp, int *mirrored){
+   assert(mp != NULL && mirrored != NULL);
+
+   uint64_t key = 0;
+   uint64_t mirrorKey = 0;
+
+   //the tokens are told apart by who played them, not by their colour
+   for(unsigned j = 0; j < mp->nbColumns; ++j){
+      for(unsigned i = 0; i < mp->nbLines; ++i){
+         Colour colour = get_packed_cell(mp->grid, i, j);
+         if(colour != none){
+            unsigned second = (colour != mp->firstColour);
+            unsigned index = get_bit_index(mp->nbLines, i, j);
+            unsigned mirror = get_bit_index(mp->nbLines, i,
+             mp->nbColumns - 1 - j);
+            key ^= mp->zobristKeys[2 * index + second];
+            mirrorKey ^= mp->zobristKeys[2 * mirror + second];
+         }
+      }
+   }
+
+   *mirrored = mirrorKey < key;
+   return *mirrored ? mirrorKey : key;
+}
+
+unsigned get_move_time(Model *mp){
+   assert(mp != NULL);
+   return mp->moveTime;
+}
+
+Level get_level(Model *mp){
+   assert(mp != NULL);
+   return mp->level;
+}
+
+unsigned get_nb_threads(Model *mp){
+   assert(mp != NULL);
+   return mp->nbThreads;
+}
+
+int *get_stop_flag(Model *mp){
+   assert(mp != NULL);
+   return mp->stopFlag;
+}
+
+const SearchInfo *get_search_info(Model *mp){
+   assert(mp != NULL);
+   return &mp->lastSearch;
+}
+
+char *get_curr_player_name(Model *mp){
+   assert(mp != NULL);
+   if(!mp->player.present){
+      return NULL;
+   }
+   return mp->player.name;
 }
 
 char *get_prev_player_name(Model *mp, unsigned rank){
@@ -431,9 +1158,56 @@ Boolean get_presence_player(Model *mp){
 Colour **get_grid(Model *mp){
    assert(mp != NULL);
 
+   if(mp->gameGrid == NULL){
+      mp->gameGrid = create_game_grid(mp->nbLines, mp->nbColumns);
+      if(mp->gameGrid == NULL){
+         return NULL;
+      }
+   }
+   else if(mp->gameGridHash == mp->hash){
+      return mp->gameGrid;
+   }
+
+   unpack_grid(mp->grid, mp->gameGrid);
+   mp->gameGridHash = mp->hash;
+
    return mp->gameGrid;
 }
 
+const PackedGrid *get_packed_grid(Model *mp){
+   assert(mp != NULL);
+
+   return mp->grid;
+}
+
+const uint8_t *get_cells(Model *mp){
+   assert(mp != NULL);
+
+   //only the cells of the grid change, the margins are written once
+   if(mp->cellsHash != mp->hash){
+      const unsigned WIDTH = mp->nbColumns + 2 * CELLS_MARGIN;
+      for(unsigned i = 0; i < mp->nbLines; ++i){
+         uint8_t *line = &mp->cells[(i + CELLS_MARGIN) * WIDTH + CELLS_MARGIN];
+         for(unsigned j = 0; j < mp->nbColumns; ++j){
+            line[j] = (uint8_t)get_packed_cell(mp->grid, i, j);
+         }
+      }
+      mp->cellsHash = mp->hash;
+   }
+
+   return mp->cells;
+}
+
+unsigned get_cells_size(unsigned nbLines, unsigned nbColumns){
+   return (nbLines + 2 * CELLS_MARGIN) * (nbColumns + 2 * CELLS_MARGIN);
+}
+
+const int *get_cases_left(Model *mp){
+   assert(mp != NULL);
+
+   return mp->casesLeft;
+}
+
 // ----------- Highscore Related functions ---------
 
 int update_highscores(Model *mp){
@@ -557,9 +1331,564 @@ void change_breakfast(Model *mp){
 
 // ----------- STATIC FUNCTIONS --------------------
 
-static int random_number(int upperLimit){
-   assert(upperLimit > 0);
+static int random_number(Model *mp, int upperLimit){
+   assert(mp != NULL && upperLimit > 0);
 
-   srand(time(NULL));
-   return rand() % upperLimit;
+   return (int)(next_key(&mp->random) % (uint64_t)upperLimit);
+}
+
+static unsigned place_token(Model *mp, unsigned column, Colour colour){
+   assert(mp != NULL && mp->casesLeft[column] >= 0);
+
+   unsigned row = (unsigned)mp->casesLeft[column];
+   unsigned index = get_bit_index(mp->nbLines, row, column);
+
+   set_packed_cell(mp->grid, row, column, colour);
+   set_bit(mp->tokens[colour], index);
+   add_to_windows(mp, row * mp->nbColumns + column, colour);
+   mp->hash ^= mp->zobristKeys[2 * index + (colour == yellow)];
+
+   //the lowest empty cell of the column is now the one above
+   reset_bit(mp->heightMask, index);
+   set_bit(mp->heightMask, index + 1);
+
+   //The pile of tokens in that column increases
+   --mp->casesLeft[column];
+   mp->history[mp->nbMoves] = column;
+   ++mp->nbMoves;
+
+   return row;
+}
+
+static int find_winning_column(Model *mp, Colour colour, int specificColumn){
+   assert(mp != NULL && (colour == red || colour == yellow));
+
+   const unsigned NBCOLUMNS = mp->nbColumns;
+   const unsigned NBLINES = mp->nbLines;
+
+   int first = 0;
+   int last = (int)NBCOLUMNS - 1;
+   if(specificColumn >= 0 && specificColumn < (int)NBCOLUMNS){
+      first = last = specificColumn;
+   }
+   else if(mp->nbWords == 1){
+      //the whole grid fits in one word: all the columns are checked at once
+      uint64_t cells = winning_cells_word(mp->tokens[colour], 1, NBLINES, 0)
+       & mp->heightMask[0] & mp->boardMask[0];
+
+      if(cells){
+         return (int)(__builtin_ctzll(cells) / (NBLINES + 1));
+      }
+      return -1;
+   }
+
+   //only the lowest empty cell of each column can be played: it wins if one
+   //of its windows holds three tokens of the colour and none of the other one
+   const unsigned OWN = (colour == yellow);
+   for(int i = first; i <= last; ++i){
+      if(!check_height(mp, i)){
+         unsigned cell = (unsigned)mp->casesLeft[i] * NBCOLUMNS + (unsigned)i;
+         for(uint32_t k = mp->windowStart[cell]; k < mp->windowStart[cell + 1];
+          ++k){
+            const uint8_t *counts = &mp->windowCounts[2 * mp->cellWindows[k]];
+            if(counts[OWN] == 3 && counts[1 - OWN] == 0){
+               return i;
+            }
+         }
+      }
+   }
+
+   return -1;
+}
+
+static unsigned compute_threat(Model *mp, int row, int column, Colour colour){
+   assert(mp != NULL && (colour == red || colour == yellow));
+
+   //horizontal, both diagonals and vertical
+   const int DIRECTIONS[4][2] = {{0, 1}, {1, 1}, {1, -1}, {1, 0}};
+   const int NBLINES = (int)mp->nbLines;
+   const int NBCOLUMNS = (int)mp->nbColumns;
+
+   unsigned level = 0;
+   for(unsigned d = 0; d < 4 && level < 3; ++d){
+      unsigned count = 0;
+      //one side of the cell, then the other one
+      for(int side = 1; side >= -1; side -= 2){
+         int dr = side * DIRECTIONS[d][0];
+         int dc = side * DIRECTIONS[d][1];
+         int r = row + dr;
+         int c = column + dc;
+         for(unsigned k = 0; k < 3 && 0 <= r && r < NBLINES && 0 <= c
+          && c < NBCOLUMNS && get_packed_cell(mp->grid, r, c) == colour; ++k){
+            ++count;
+            r += dr;
+            c += dc;
+         }
+      }
+      if(count > level){
+         level = count > 3 ? 3 : count;
+      }
+   }
+
+   return level;
+}
+
+static void update_threats(Model *mp, unsigned row, unsigned column,
+ Colour colour){
+   assert(mp != NULL && (colour == red || colour == yellow));
+
+   const int DIRECTIONS[4][2] = {{0, 1}, {1, 1}, {1, -1}, {1, 0}};
+   const int NBLINES = (int)mp->nbLines;
+   const int NBCOLUMNS = (int)mp->nbColumns;
+   const unsigned OWN = (colour == yellow);
+
+   //an occupied cell doesn't threaten anything
+   uint8_t *cell = &mp->threats[2 * (row * mp->nbColumns + column)];
+   cell[0] = cell[1] = 0;
+   if(get_packed_cell(mp->grid, row, column) == none){
+      cell[0] = (uint8_t)compute_threat(mp, (int)row, (int)column, red);
+      cell[1] = (uint8_t)compute_threat(mp, (int)row, (int)column, yellow);
+   }
+
+   //the lines of the other colour never went through the cell (it was empty)
+   for(unsigned d = 0; d < 4; ++d){
+      for(int side = 1; side >= -1; side -= 2){
+         int dr = side * DIRECTIONS[d][0];
+         int dc = side * DIRECTIONS[d][1];
+         int r = (int)row + dr;
+         int c = (int)column + dc;
+         for(unsigned k = 0; k < 3 && 0 <= r && r < NBLINES && 0 <= c
+          && c < NBCOLUMNS; ++k){
+            Colour current = get_packed_cell(mp->grid, r, c);
+            if(current == none){
+               mp->threats[2 * (r * NBCOLUMNS + c) + OWN] =
+                (uint8_t)compute_threat(mp, r, c, colour);
+            }
+            if(current != colour){
+               break;
+            }
+            r += dr;
+            c += dc;
+         }
+      }
+   }
+}
+
+static void catch_up_threats(Model *mp){
+   assert(mp != NULL);
+
+   /* the moves are taken from the last one: the row of a move is the one above
+    * the tokens of its column, the heights being lowered on the way. Every
+    * update reads the whole grid, so the order doesn't matter */
+   for(unsigned m = mp->nbMoves; m > mp->threatsMoves; --m){
+      unsigned column = mp->history[m - 1];
+      unsigned row = (unsigned)(++mp->casesLeft[column]);
+      update_threats(mp, row, column, get_packed_cell(mp->grid, row, column));
+   }
+   for(unsigned m = mp->threatsMoves; m < mp->nbMoves; ++m){
+      --mp->casesLeft[mp->history[m]];
+   }
+
+   mp->threatsMoves = mp->nbMoves;
+}
+
+static int find_threat_column(Model *mp, unsigned level, Colour colour){
+   assert(mp != NULL && (colour == red || colour == yellow));
+
+   const unsigned NBCOLUMNS = mp->nbColumns;
+
+   //the moves of a search or of another model aren't in the threats yet
+   catch_up_threats(mp);
+
+   //only the lowest empty cell of each column can be played
+   for(unsigned i = 0; i < NBCOLUMNS; ++i){
+      if(mp->casesLeft[i] >= 0){
+         unsigned row = (unsigned)mp->casesLeft[i];
+         if(mp->threats[2 * (row * NBCOLUMNS + i) + (colour == yellow)] >= level){
+            return (int)i;
+         }
+      }
+   }
+
+   return -1;
+}
+
+static unsigned count_windows(unsigned nbLines, unsigned nbColumns){
+   unsigned lines = nbLines >= 4 ? nbLines - 3 : 0;
+   unsigned columns = nbColumns >= 4 ? nbColumns - 3 : 0;
+
+   //horizontal, vertical, then both diagonals
+   return nbLines * columns + lines * nbColumns + 2 * lines * columns;
+}
+
+static int create_windows(Model *mp){
+   assert(mp != NULL);
+
+   //horizontal, vertical and both diagonals
+   const int DIRECTIONS[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+   const int NBLINES = (int)mp->nbLines;
+   const int NBCOLUMNS = (int)mp->nbColumns;
+   const unsigned NBCELLS = mp->nbLines * mp->nbColumns;
+
+   mp->windowStart = malloc(sizeof(uint32_t) * (NBCELLS + 1));
+   mp->cellWindows = malloc(sizeof(uint32_t) * 4 * (mp->nbWindows + 1));
+   uint32_t *next = malloc(sizeof(uint32_t) * NBCELLS);
+   if(mp->windowStart == NULL || mp->cellWindows == NULL || next == NULL){
+      free(next);
+      return -1;
+   }
+
+   //the windows are listed twice: once to count those of each cell, then to
+   //store them
+   memset(next, 0, sizeof(uint32_t) * NBCELLS);
+   for(int pass = 0; pass < 2; ++pass){
+      uint32_t window = 0;
+      for(unsigned d = 0; d < 4; ++d){
+         const int DR = DIRECTIONS[d][0];
+         const int DC = DIRECTIONS[d][1];
+         for(int r = 0; r + 3 * DR < NBLINES; ++r){
+            for(int c = 0; c < NBCOLUMNS; ++c){
+               if(c + 3 * DC < 0 || c + 3 * DC >= NBCOLUMNS){
+                  continue;
+               }
+               for(int k = 0; k < 4; ++k){
+                  unsigned cell = (unsigned)((r + k * DR) * NBCOLUMNS + c + k * DC);
+                  if(pass == 0){
+                     ++next[cell];
+                  }
+                  else{
+                     mp->cellWindows[next[cell]++] = window;
+                  }
+               }
+               ++window;
+            }
+         }
+      }
+      assert(window == mp->nbWindows);
+
+      if(pass == 0){
+         //each cell starts where the windows of the previous one end
+         mp->windowStart[0] = 0;
+         for(unsigned i = 0; i < NBCELLS; ++i){
+            mp->windowStart[i + 1] = mp->windowStart[i] + next[i];
+            next[i] = mp->windowStart[i];
+         }
+      }
+   }
+
+   free(next);
+   return 1;
+}
+
+static void add_to_windows(Model *mp, unsigned cell, Colour colour){
+   assert(mp != NULL && (colour == red || colour == yellow));
+
+   const unsigned OWN = (colour == yellow);
+   for(uint32_t i = mp->windowStart[cell]; i < mp->windowStart[cell + 1]; ++i){
+      uint8_t *counts = &mp->windowCounts[2 * mp->cellWindows[i]];
+      if(counts[1 - OWN] == 0){
+         //the window stays open for the colour, with one more token
+         --mp->openWindows[OWN][counts[OWN]];
+         ++mp->openWindows[OWN][counts[OWN] + 1];
+      }
+      if(counts[OWN] == 0){
+         //the window is closed for the other colour
+         --mp->openWindows[1 - OWN][counts[1 - OWN]];
+      }
+      ++counts[OWN];
+   }
+}
+
+static void remove_from_windows(Model *mp, unsigned cell, Colour colour){
+   assert(mp != NULL && (colour == red || colour == yellow));
+
+   const unsigned OWN = (colour == yellow);
+   for(uint32_t i = mp->windowStart[cell]; i < mp->windowStart[cell + 1]; ++i){
+      uint8_t *counts = &mp->windowCounts[2 * mp->cellWindows[i]];
+      --counts[OWN];
+      if(counts[1 - OWN] == 0){
+         --mp->openWindows[OWN][counts[OWN] + 1];
+         ++mp->openWindows[OWN][counts[OWN]];
+      }
+      if(counts[OWN] == 0){
+         //the window is open again for the other colour
+         ++mp->openWindows[1 - OWN][counts[1 - OWN]];
+      }
+   }
+}
+
+static uint64_t next_key(uint64_t *state){
+   assert(state != NULL);
+
+   uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+   z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+   z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+   return z ^ (z >> 31);
+}
+
+static Model *allocate_model(unsigned nbLines, unsigned nbColumns){
+
+   Model* mp = malloc(sizeof(Model));
+   if(mp == NULL){
+      return NULL;
+   }
+
+   mp->grid = create_packed_grid(nbLines, nbColumns);
+   if(mp->grid == NULL){
+      free(mp);
+      return NULL;
+   }
+   mp->gameGrid = NULL;
+
+   mp->casesLeft = malloc(sizeof(int) * nbColumns);
+   if(mp->casesLeft == NULL){
+      free_packed_grid(mp->grid);
+      free(mp);
+      return NULL;
+   }
+
+   //the four bitboards are stored in one block, starting with the board mask
+   mp->nbWords = get_nb_words(nbLines, nbColumns);
+   mp->boardMask = malloc(sizeof(uint64_t) * 4 * mp->nbWords);
+   if(mp->boardMask == NULL){
+      free_packed_grid(mp->grid);
+      free(mp->casesLeft);
+      free(mp);
+      return NULL;
+   }
+   mp->tokens[none] = NULL;
+   mp->tokens[red] = mp->boardMask + mp->nbWords;
+   mp->tokens[yellow] = mp->tokens[red] + mp->nbWords;
+   mp->heightMask = mp->tokens[yellow] + mp->nbWords;
+   fill_board_mask(mp->boardMask, mp->nbWords, nbLines, nbColumns);
+
+   mp->zobristKeys = malloc(sizeof(uint64_t) * 2 * 64 * mp->nbWords);
+   if(mp->zobristKeys == NULL){
+      free_packed_grid(mp->grid);
+      free(mp->casesLeft);
+      free(mp->boardMask);
+      free(mp);
+      return NULL;
+   }
+   uint64_t state = ZOBRIST_SEED;
+   for(unsigned i = 0; i < 2 * 64 * mp->nbWords; ++i){
+      mp->zobristKeys[i] = next_key(&state);
+   }
+
+   mp->threats = malloc(sizeof(uint8_t) * 2 * nbLines * nbColumns);
+   if(mp->threats == NULL){
+      free_packed_grid(mp->grid);
+      free(mp->casesLeft);
+      free(mp->boardMask);
+      free(mp->zobristKeys);
+      free(mp);
+      return NULL;
+   }
+
+   //one more window, so that a grid without any isn't an error
+   mp->nbWindows = count_windows(nbLines, nbColumns);
+   mp->windowCounts = malloc(sizeof(uint8_t) * 2 * (mp->nbWindows + 1));
+   if(mp->windowCounts == NULL){
+      free_packed_grid(mp->grid);
+      free(mp->casesLeft);
+      free(mp->boardMask);
+      free(mp->zobristKeys);
+      free(mp->threats);
+      free(mp);
+      return NULL;
+   }
+   mp->windowStart = NULL;
+   mp->cellWindows = NULL;
+
+   //4 more bytes: the cells may be read 4 bytes at a time
+   mp->cells = malloc(sizeof(uint8_t) * (get_cells_size(nbLines, nbColumns) + 4));
+   if(mp->cells == NULL){
+      free_packed_grid(mp->grid);
+      free(mp->casesLeft);
+      free(mp->boardMask);
+      free(mp->zobristKeys);
+      free(mp->threats);
+      free(mp->windowCounts);
+      free(mp);
+      return NULL;
+   }
+
+   //the moves played and the moves taken back are stored in one block
+   mp->history = malloc(sizeof(unsigned) * 2 * nbLines * nbColumns);
+   if(mp->history == NULL){
+      free_packed_grid(mp->grid);
+      free(mp->casesLeft);
+      free(mp->boardMask);
+      free(mp->zobristKeys);
+      free(mp->threats);
+      free(mp->windowCounts);
+      free(mp->cells);
+      free(mp);
+      return NULL;
+   }
+   mp->redos = mp->history + nbLines * nbColumns;
+   mp->nbRedos = 0;
+
+   /* the copies of the grid describe the empty one (whose key is 0) until
+    * they are needed. The margins are marked as holding both colours: no
+    * window goes through them */
+   memset(mp->threats, 0, sizeof(uint8_t) * 2 * nbLines * nbColumns);
+   mp->threatsMoves = 0;
+   const unsigned WIDTH = nbColumns + 2 * CELLS_MARGIN;
+   memset(mp->cells, red | yellow,
+    sizeof(uint8_t) * get_cells_size(nbLines, nbColumns));
+   for(unsigned i = 0; i < nbLines; ++i){
+      memset(&mp->cells[(i + CELLS_MARGIN) * WIDTH + CELLS_MARGIN], none,
+       sizeof(uint8_t) * nbColumns);
+   }
+   mp->cellsHash = 0;
+
+   mp->nbLines = nbLines;
+   mp->nbColumns = nbColumns;
+   mp->table = NULL;
+
+   return mp;
+}
+
+static void copy_model(Model *copy, Model *mp){
+   assert(copy != NULL && mp != NULL);
+
+   /* the pointers of the copy are kept, the rest is copied. The copies of
+    * the grid made on demand (Colour, cells) stay the ones of the copy, with
+    * their keys */
+   PackedGrid *grid = copy->grid;
+   Colour **gameGrid = copy->gameGrid;
+   uint64_t gameGridHash = copy->gameGridHash;
+   uint64_t cellsHash = copy->cellsHash;
+   int *casesLeft = copy->casesLeft;
+   uint64_t *boardMask = copy->boardMask;
+   uint64_t *zobristKeys = copy->zobristKeys;
+   uint8_t *threats = copy->threats;
+   uint8_t *windowCounts = copy->windowCounts;
+   uint8_t *cells = copy->cells;
+   unsigned *history = copy->history;
+
+   *copy = *mp;
+   copy->grid = grid;
+   copy->gameGrid = gameGrid;
+   copy->gameGridHash = gameGridHash;
+   copy->casesLeft = casesLeft;
+   copy->boardMask = boardMask;
+   copy->tokens[red] = boardMask + mp->nbWords;
+   copy->tokens[yellow] = copy->tokens[red] + mp->nbWords;
+   copy->heightMask = copy->tokens[yellow] + mp->nbWords;
+   copy->zobristKeys = zobristKeys;
+   copy->threats = threats;
+   copy->windowCounts = windowCounts;
+   copy->cells = cells;
+   copy->cellsHash = cellsHash;
+   copy->history = history;
+   copy->redos = history + mp->nbLines * mp->nbColumns;
+   copy->nbRedos = 0;
+   copy->isCopy = true;
+
+   //the copy doesn't draw the same random numbers as the model
+   uint64_t state = mp->random ^ (uint64_t)(uintptr_t)copy;
+   copy->random = next_key(&state);
+
+   copy_position(copy, mp);
+}
+
+static void copy_position(Model *destination, Model *source){
+   assert(destination != NULL && source != NULL);
+
+   destination->player.colour = source->player.colour;
+   destination->machineColour = source->machineColour;
+   destination->firstColour = source->firstColour;
+   destination->nbMoves = source->nbMoves;
+   destination->hash = source->hash;
+   destination->threatsMoves = source->threatsMoves;
+   memcpy(destination->openWindows, source->openWindows,
+    sizeof(source->openWindows));
+
+   //the Zobrist keys are the same for every model of that size
+   copy_packed_grid(destination->grid, source->grid);
+   memcpy(destination->threats, source->threats,
+    sizeof(uint8_t) * 2 * source->nbLines * source->nbColumns);
+   memcpy(destination->casesLeft, source->casesLeft,
+    sizeof(int) * source->nbColumns);
+   memcpy(destination->boardMask, source->boardMask,
+    sizeof(uint64_t) * 4 * source->nbWords);
+   memcpy(destination->windowCounts, source->windowCounts,
+    sizeof(uint8_t) * 2 * source->nbWindows);
+   memcpy(destination->history, source->history,
+    sizeof(unsigned) * source->nbMoves);
+}
+
+static unsigned heuristic_column(Model *mp){
+   assert(mp != NULL);
+
+   int colTemp = 0;
+
+   //Step 0: Play the move of the opening book (if there is one)
+   colTemp = get_book_column(mp, NULL);
+
+   //Step 1: Check victory for the computer
+   if(colTemp == -1){
+      colTemp = find_threat_column(mp, 3, mp->machineColour);
+   }
+
+   //Step 2: Prevent player from winning (if not step 1)
+   if(colTemp == -1){
+      colTemp = find_threat_column(mp, 3, mp->player.colour);
+   }
+
+   //Step 3: Add a third token (if not steps 1 & 2)
+   if(colTemp == -1){
+      colTemp = find_threat_column(mp, 2, mp->machineColour);
+   }
+
+   //Step 4: Prevent a third token to be added (if not steps 1, 2 & 3)
+   if(colTemp == -1){
+      colTemp = find_threat_column(mp, 2, mp->player.colour);
+   }
+
+   //Step 5: Choose a random column to add a token (last option)
+   if(colTemp == -1){
+      colTemp = random_number(mp, mp->nbColumns);
+      //if the column chosen is full, we take the next one that isn't
+      while(mp->casesLeft[colTemp] < 0){
+         colTemp = (colTemp + 1) % mp->nbColumns;
+      }
+   }
+
+   return (unsigned)colTemp;
+}
+
+static unsigned search_column(Model *mp){
+   assert(mp != NULL);
+
+   int column;
+   if(mp->moveTime > 0){
+      column = search_best_column_timed(mp, mp->moveTime, &mp->lastSearch);
+   }
+   else{
+      column = search_best_column(mp, mp->searchDepth, &mp->lastSearch);
+   }
+
+   //if the search couldn't be done, the heuristic still gives a move
+   if(column == -1){
+      return heuristic_column(mp);
+   }
+   return (unsigned)column;
+}
+
+static unsigned mcts_column(Model *mp){
+   assert(mp != NULL);
+
+   int column = -1;
+   if(mp->mcts != NULL){
+      column = search_mcts(mp->mcts, mp, mp->moveTime, &mp->lastSearch);
+   }
+
+   //if the search couldn't be done, the heuristic still gives a move
+   if(column == -1){
+      return heuristic_column(mp);
+   }
+   return (unsigned)column;
 }
@@ -12,12 +12,24 @@
 #ifndef ___MODEL___
 #define ___MODEL___
 
+#include <stdint.h>
+
+#include "transposition.h"
+#include "book.h"
+
 typedef enum{none, red, yellow}Colour;
 
+/**
+ * @brief Number of cells around the grid in the copy given by get_cells()
+ */
+#define CELLS_MARGIN 3
+
 typedef enum{lose, win, draw}Result;
 
 typedef enum{false, true}Boolean;
 
+typedef enum{easy, hard, montecarlo}Level;
+
 typedef struct user_t User;
 
 /**
@@ -26,6 +38,20 @@ typedef struct user_t User;
  */
 typedef struct model_t Model;
 
+/**
+ * \brief Declaration of the information about the last search of the A.I.
+ * (implemented in ai.h)
+ *
+ */
+typedef struct search_info_t SearchInfo;
+
+/**
+ * \brief Declaration of the grid packed in one block of memory (implemented
+ * in grid.h)
+ *
+ */
+typedef struct packed_grid_t PackedGrid;
+
 /**
  * @brief Creates a pointer on the model
  * 
@@ -39,6 +65,58 @@ typedef struct model_t Model;
  */
 Model *create_model(unsigned nbLines, unsigned nbColumns);
 
+/**
+ * @brief Creates a copy of the position of a model, used by the threads of
+ *  the search
+ *
+ * @remark The copy shares the transposition table of the model (it doesn't
+ * free it), everything else is its own. It must be freed before the model.
+ *
+ * @param mp pointer on the model.
+ *
+ * @pre mp != NULL
+ * @post Returns the address of the copy, NULL if something went wrong.
+ *
+ * @return Model*
+ */
+Model *duplicate_model(Model *mp);
+
+/**
+ * @brief Turns a copy made by duplicate_model() into a copy of another
+ *  position, without allocating anything
+ *
+ * @remark The slot gets the position and the settings of the model and shares
+ * the same things as any copy (transposition table, opening book, tree of the
+ * level montecarlo, highscores, tables of the windows). It is meant to be
+ * kept and handed to a thread for every new search.
+ *
+ * @param slot pointer on the copy.
+ * @param mp pointer on the model copied.
+ *
+ * @pre slot != NULL, mp != NULL, slot != mp
+ * @post slot is a copy of mp. Returns 1, -1 if slot isn't a copy or if the
+ * grids don't have the same size (nothing is changed).
+ */
+int clone_model(Model *slot, Model *mp);
+
+/**
+ * @brief Puts back in a model a position saved in another one
+ *
+ * @remark Only the position is copied (tokens, lowest empty cells, key,
+ * colours and whose turn it is, incremental data): the settings, the score
+ * and what the model owns are kept. The moves taken back by undo_move()
+ * can't be played again anymore.
+ *
+ * @param mp pointer on the model.
+ * @param snapshot pointer on the model holding the position (a copy made by
+ * duplicate_model() or clone_model() for instance).
+ *
+ * @pre mp != NULL, snapshot != NULL, mp != snapshot
+ * @post mp is in the position of snapshot. Returns 1, -1 if the grids don't
+ * have the same size (nothing is changed).
+ */
+int restore_model(Model *mp, Model *snapshot);
+
 /**
  * @brief Creates dynamically the grid of the game
  * 
@@ -46,8 +124,8 @@ Model *create_model(unsigned nbLines, unsigned nbColumns);
  * @param nbColumns number of columns of the grid
  * 
  * @pre nbLines > 0, nbColumns > 0
- * @post returns the address of the grid,
- * or NULL if something went wrong.
+ * @post returns the address of the grid (the pointers on the lines and the
+ * cells are one block of memory), or NULL if something went wrong.
  */
 Colour **create_game_grid(unsigned nbLines, unsigned nbColumns);
 
@@ -103,6 +181,44 @@ void free_model(Model *mp);
  */
 int check_grid(Model *mp, int range, Colour colour, int specificColumn);
 
+/**
+ * @brief Checks if the token of a cell forms a Connect 4, by looking only at
+ *  the four lines going through that cell
+ *
+ * @remark It is meant to be used on the last token placed and runs in
+ * constant time, whatever the size of the grid is: the model keeps the number
+ * of tokens of each colour in every window of four cells in a row, and only
+ * the windows of the cell (16 at most) are read.
+ *
+ * @param mp a pointer on the model.
+ * @param rowPosition the row of the cell.
+ * @param columnPosition the column of the cell.
+ *
+ * @pre mp != NULL, the cell is in the grid
+ * @post returns 1 if the token of the cell aligns four tokens of its colour,
+ *       0 otherwise (or if the cell is empty).
+ *
+ * @return int 1 if there is a Connect 4,
+ *         int 0 if there isn't.
+ */
+int check_alignment(Model *mp, unsigned rowPosition, unsigned columnPosition);
+
+/**
+ * @brief Evaluates a position by counting the windows of four cells in a row
+ *  that a colour can still fill
+ *
+ * @remark A window holding k tokens of a colour and none of the other one is
+ * worth 1, 4 or 16 points for k = 1, 2 or 3. The counts are kept up to date
+ * with each token, the evaluation doesn't read the grid.
+ *
+ * @param mp pointer on the model.
+ * @param colour colour the score is given for.
+ *
+ * @pre mp != NULL, colour == red || colour == yellow
+ * @post returns the points of the colour minus the ones of the other colour.
+ */
+int evaluate_windows(Model *mp, Colour colour);
+
 /**
  * @brief Adds a token in the grid for the player
  * 
@@ -134,6 +250,151 @@ unsigned add_token_player(Model *mp, unsigned columnPosition, Result *result);
  */
 unsigned add_token_ai(Model *mp, unsigned *columnPosition, Result *result);
 
+/**
+ * @brief Adds a token in the grid for the computer, chosen by a search of the
+ *  game tree (level "hard")
+ *
+ * @param mp pointer on the model.
+ * @param columnPosition a pointer that will store the index of
+ *  the column chosen by the computer.
+ * @param result a pointer that will store the result of the move.
+ *
+ * @pre mp != NULL, the grid isn't full
+ * @post returns the position of the row the token has been placed in and
+ * tells if the computer won through the pointer Result *result. The
+ * information about the search can be read with get_search_info().
+ *
+ * @return unsigned int rowPosition
+ */
+unsigned add_token_ai_search(Model *mp, unsigned *columnPosition,
+ Result *result);
+
+/**
+ * @brief Adds a token in the grid for the computer, chosen by a Monte Carlo
+ *  tree search (level "montecarlo")
+ *
+ * @remark The threads of the model (see set_nb_threads()) share the tree of
+ * the search.
+ *
+ * @param mp pointer on the model.
+ * @param columnPosition a pointer that will store the index of
+ *  the column chosen by the computer.
+ * @param result a pointer that will store the result of the move.
+ *
+ * @pre mp != NULL, the grid isn't full, the level has been set to montecarlo
+ * (otherwise the heuristic of add_token_ai() is used)
+ * @post returns the position of the row the token has been placed in and
+ * tells if the computer won through the pointer Result *result. The
+ * information about the search can be read with get_search_info().
+ *
+ * @return unsigned int rowPosition
+ */
+unsigned add_token_ai_mcts(Model *mp, unsigned *columnPosition,
+ Result *result);
+
+/**
+ * @brief Chooses the column of the computer according to its level, without
+ *  placing the token
+ *
+ * @remark This is the slow part of the computer's turn: it can be done on a
+ * copy of the model (see duplicate_model()) by another thread, the token is
+ * then placed with play_token_ai().
+ *
+ * @param mp pointer on the model.
+ *
+ * @pre mp != NULL, the grid isn't full
+ * @post returns the index of the column chosen by the computer.
+ */
+unsigned choose_column_ai(Model *mp);
+
+/**
+ * @brief Places the token of the computer in a column
+ *
+ * @param mp pointer on the model.
+ * @param columnPosition index of the column chosen by the computer.
+ * @param result a pointer that will store the result of the move.
+ *
+ * @pre mp != NULL, the column isn't full
+ * @post returns the position of the row the token has been placed in and
+ * tells if the computer won through the pointer Result *result.
+ *
+ * @return unsigned int rowPosition
+ */
+unsigned play_token_ai(Model *mp, unsigned columnPosition, Result *result);
+
+/**
+ * @brief Places a token of the colour whose turn it is, without any other
+ *  consequence on the game (score, result)
+ *
+ * @remark Used by the search of the A.I. with unmake_move(), to explore the
+ * game tree on the model itself instead of on copies.
+ *
+ * @param mp pointer on the model.
+ * @param column index of the column.
+ *
+ * @pre mp != NULL, the column isn't full
+ * @post the token is placed and it is the other colour's turn. Returns the
+ * position of the row the token has been placed in.
+ *
+ * @return unsigned int rowPosition
+ */
+unsigned make_move(Model *mp, unsigned column);
+
+/**
+ * @brief Removes the last token placed in a column
+ *
+ * @param mp pointer on the model.
+ * @param column index of the column.
+ *
+ * @pre mp != NULL, the last token placed in the grid is in that column
+ * @post the token is removed and it is its colour's turn again.
+ */
+void unmake_move(Model *mp, unsigned column);
+
+/**
+ * @brief Takes back the last move of the game
+ *
+ * @remark Unlike unmake_move(), the player's score goes back too, and the
+ * move can be played again with redo_move() until a new token is added by
+ * add_token_player() or play_token_ai().
+ *
+ * @param mp pointer on the model.
+ *
+ * @pre mp != NULL
+ * @post the last token is removed. Returns its column, -1 if the grid was
+ * empty.
+ */
+int undo_move(Model *mp);
+
+/**
+ * @brief Plays again the last move taken back by undo_move()
+ *
+ * @param mp pointer on the model.
+ *
+ * @pre mp != NULL
+ * @post the token is placed again and the player's score with it. Returns
+ * its column, -1 if there wasn't any move to play again.
+ */
+int redo_move(Model *mp);
+
+/**
+ * @brief Plays a sequence of moves written as text, one colour after the
+ *  other from the colour whose turn it is
+ *
+ * @remark The columns are numbered from 1. Up to 9 columns, each digit is a
+ * move ("4453" for instance); with more columns, the numbers are separated by
+ * any other character ("10,11,10"). The moves are placed with make_move(),
+ * without any other consequence on the game.
+ *
+ * @param mp pointer on the model.
+ * @param moves the moves.
+ *
+ * @pre mp != NULL, moves != NULL
+ * @post returns the number of moves played, -1 (and the model didn't change)
+ * if a column doesn't exist or is full or if a move follows a Connect 4.
+ */
+int play_moves(Model *mp, const char *moves);
+
 /**
  * @brief Checks if a column is completely filled
  * 
@@ -173,6 +434,116 @@ void set_name(Model *mp, char *name);
  */
 void set_highscores_file(Model *mp, char *highscoresFile);
 
+/**
+ * @brief Sets the size of the transposition table used by the search
+ *
+ * @param mp pointer on the model.
+ * @param megabytes memory the table may use (in MB), 0 to search without
+ * any table.
+ *
+ * @pre mp != NULL
+ * @post the previous table is freed and replaced by an empty one.
+ *
+ * @return int 1 if the table has been created,
+ *         int -1 if it couldn't be (the model has no table anymore).
+ */
+int set_table_size(Model *mp, unsigned megabytes);
+
+/**
+ * @brief Opens the opening book the computer looks into before searching
+ *
+ * @param mp pointer on the model.
+ * @param filename name of the file of the book, NULL to close the book.
+ *
+ * @pre mp != NULL
+ * @post the book replaces the previous one of the model.
+ *
+ * @return int 1 if the book has been opened (or closed),
+ *         int -1 if it can't be opened or is made for another grid size (the
+ *         model has no book anymore).
+ */
+int set_book(Model *mp, const char *filename);
+
+/**
+ * @brief Sets the time the computer may take to choose a column (level hard)
+ *
+ * @param mp pointer on the model.
+ * @param milliseconds time given for each move, 0 to search at a fixed depth
+ * instead (chosen according to the size of the grid).
+ *
+ * @pre mp != NULL
+ * @post the time is saved in the model.
+ */
+void set_move_time(Model *mp, unsigned milliseconds);
+
+/**
+ * @brief Sets the level of the computer
+ *
+ * @param mp pointer on the model.
+ * @param level easy (heuristic of add_token_ai), hard (search of
+ * add_token_ai_search) or montecarlo (Monte Carlo tree search, see mcts.h).
+ *
+ * @pre mp != NULL
+ * @post the level is saved in the model.
+ */
+void set_level(Model *mp, Level level);
+
+/**
+ * @brief Sets the number of threads searching at the same time
+ *
+ * @param mp pointer on the model.
+ * @param nbThreads number of threads (1 by default).
+ *
+ * @pre mp != NULL, nbThreads > 0
+ * @post the number of threads is saved in the model.
+ */
+void set_nb_threads(Model *mp, unsigned nbThreads);
+
+/**
+ * @brief Gives a flag that stops the search of the computer as soon as it is
+ *  set (by another thread) to a value other than 0
+ *
+ * @remark The flag is shared by the copies of the model made afterwards.
+ *
+ * @param mp pointer on the model.
+ * @param stop address of the flag, NULL to remove it.
+ *
+ * @pre mp != NULL
+ * @post the flag is saved in the model.
+ */
+void set_stop_flag(Model *mp, int *stop);
+
+/**
+ * @brief Sets the state of the random numbers of a model
+ *
+ * @remark Every model draws its own random numbers (the colour picked by
+ * initialise_game_model(), the last step of the level easy), from the time
+ * it has been created by default. Two models with the same seed play the
+ * same games.
+ *
+ * @param mp pointer on the model.
+ * @param seed the new state.
+ *
+ * @pre mp != NULL
+ * @post the next random numbers of the model only depend on the seed.
+ */
+void set_seed(Model *mp, uint64_t seed);
+
+/**
+ * @brief Chooses the colour of the first token of the game
+ *
+ * @remark initialise_game_model() lets the player start: this lets the
+ * computer start instead (when it plays against another computer).
+ *
+ * @param mp pointer on the model.
+ * @param colour colour of the first token (red or yellow).
+ *
+ * @pre mp != NULL
+ * @post returns 1 if the colour has been set, -1 if a token has already been
+ * placed or if the colour doesn't exist.
+ */
+int set_first_colour(Model *mp, Colour colour);
+
 //------------ getters functions ------------------
 
 /**
@@ -217,6 +588,155 @@ Colour get_player_colour(Model* mp);
  */
 Colour get_ai_colour(Model* mp);
 
+/**
+ * @brief Gets the colour of the token that will be placed next
+ *
+ * @param mp pointer on the model.
+ *
+ * @pre mp != NULL
+ * @post returns the colour whose turn it is (the player starts the game).
+ * @return Colour (red or yellow)
+ */
+Colour get_side_to_move(Model *mp);
+
+/**
+ * @brief Gets the number of tokens placed in the grid
+ *
+ * @param mp pointer on the model.
+ *
+ * @pre mp != NULL
+ * @post returns the number of tokens in the grid.
+ */
+unsigned get_nb_moves(Model *mp);
+
+/**
+ * @brief Gives the column of a move of the game
+ *
+ * @param mp pointer on the model.
+ * @param rank index of the move (0 is the first one).
+ *
+ * @pre mp != NULL, rank < get_nb_moves(mp)
+ * @post returns the column the token has been placed in.
+ */
+unsigned get_move(Model *mp, unsigned rank);
+
+/**
+ * @brief Gets the Zobrist key of the current position
+ *
+ * @remark The key is updated incrementally each time a token is placed or
+ * removed.
+ *
+ * @param mp pointer on the model.
+ *
+ * @pre mp != NULL
+ * @post returns the key of the position.
+ */
+uint64_t get_hash(Model *mp);
+
+/**
+ * @brief Gets the transposition table of the search
+ *
+ * @param mp pointer on the model.
+ *
+ * @pre mp != NULL
+ * @post returns the table, NULL if the model doesn't have one.
+ */
+TranspositionTable *get_table(Model *mp);
+
+/**
+ * @brief Tells if the model is a copy sharing the table of another one
+ *
+ * @remark The searches of a copy don't change the age of the table (see
+ * new_search_table()): several copies may search at the same time, so this is
+ * done once by the owner of the table before they start.
+ *
+ * @param mp pointer on the model.
+ *
+ * @pre mp != NULL
+ * @post returns true if the model was made by duplicate_model(), false
+ * otherwise.
+ */
+Boolean is_copy(Model *mp);
+
+/**
+ * @brief Gets the opening book of the computer
+ *
+ * @param mp pointer on the model.
+ *
+ * @pre mp != NULL
+ * @post returns the book, NULL if the model doesn't have one.
+ */
+OpeningBook *get_book(Model *mp);
+
+/**
+ * @brief Computes the key of the position in the opening book
+ *
+ * @remark The key doesn't depend on the colour of the player who started, and
+ * a position and its mirror have the same one: the smallest of their two
+ * keys, the columns of the book being the ones of that position.
+ *
+ * @param mp pointer on the model.
+ * @param mirrored a pointer that will store 1 if the key is the one of the
+ * mirror of the position (column i of the book is then column
+ * nbColumns - 1 - i of the grid), 0 otherwise.
+ *
+ * @pre mp != NULL, mirrored != NULL
+ * @post returns the key of the position.
+ */
+uint64_t get_book_key(Model *mp, int *mirrored);
+
+/**
+ * @brief Gets the time the computer may take to choose a column
+ *
+ * @param mp pointer on the model.
+ *
+ * @pre mp != NULL
+ * @post returns the time in ms, 0 if the search has a fixed depth.
+ */
+unsigned get_move_time(Model *mp);
+
+/**
+ * @brief Gets the level of the computer
+ *
+ * @param mp pointer on the model.
+ *
+ * @pre mp != NULL
+ * @post returns the level of the computer.
+ * @return Level (easy or hard)
+ */
+Level get_level(Model *mp);
+
+/**
+ * @brief Gets the number of threads of the search
+ *
+ * @param mp pointer on the model.
+ *
+ * @pre mp != NULL
+ * @post returns the number of threads searching at the same time.
+ */
+unsigned get_nb_threads(Model *mp);
+
+/**
+ * @brief Gets the flag stopping the search of the computer
+ *
+ * @param mp pointer on the model.
+ *
+ * @pre mp != NULL
+ * @post returns the address of the flag, NULL if there isn't any.
+ */
+int *get_stop_flag(Model *mp);
+
+/**
+ * @brief Gets the information about the last search of the computer
+ *
+ * @param mp pointer on the model.
+ *
+ * @pre mp != NULL
+ * @post returns the depth, score, column and number of nodes of the last
+ * search done by add_token_ai_search.
+ */
+const SearchInfo *get_search_info(Model *mp);
+
 /**
  * @brief Gets the current player's name (if it exists)
  * 
@@ -283,13 +803,68 @@ Boolean get_presence_player(Model *mp);
  * 
  * @param mp pointer on the model.
  * 
+ * @remark The grid is a copy of the packed grid (see get_packed_grid()),
+ * rebuilt when the position has changed since the last call: it is only
+ * meant for the display, not for the search.
+ *
  * @pre mp != NULL
- * @post returns the grid of the game in its current state.
+ * @post returns the grid of the game in its current state, NULL if something
+ * went wrong.
  * 
  * @return Colour** game grid 
  */
 Colour **get_grid(Model *mp);
 
+/**
+ * @brief Gets the grid of the game packed in one block of memory
+ *
+ * @param mp pointer on the model.
+ *
+ * @pre mp != NULL
+ * @post returns the grid, kept up to date with each token (read its cells
+ * with get_packed_cell()).
+ */
+const PackedGrid *get_packed_grid(Model *mp);
+
+/**
+ * @brief Gets a copy of the grid stored in one block of memory
+ *
+ * @remark The grid is surrounded by CELLS_MARGIN cells on each side and
+ * stored line after line, from the top: the cell (row, column) is at
+ * (row + CELLS_MARGIN) * (nbColumns + 2 * CELLS_MARGIN) + column +
+ * CELLS_MARGIN. A cell holds its Colour, the margins hold red | yellow. Three
+ * cells can be read past a cell of the grid in every direction without
+ * checking the bounds, and 4 bytes can be read from any cell.
+ *
+ * @param mp pointer on the model.
+ *
+ * @pre mp != NULL
+ * @post returns the cells, rebuilt from the packed grid if the position has
+ * changed since the last call.
+ */
+const uint8_t *get_cells(Model *mp);
+
+/**
+ * @brief Gives the number of cells of the copy of a grid given by get_cells()
+ *
+ * @param nbLines Number of lines of the grid
+ * @param nbColumns Number of columns of the grid
+ *
+ * @pre /
+ * @post returns the number of cells, margins included.
+ */
+unsigned get_cells_size(unsigned nbLines, unsigned nbColumns);
+
+/**
+ * @brief Gets the row of the lowest empty cell of each column
+ *
+ * @param mp pointer on the model.
+ *
+ * @pre mp != NULL
+ * @post returns one row per column, -1 if the column is full.
+ */
+const int *get_cases_left(Model *mp);
+
 //----------------FUNCTIONS HIGHSCORES RELATED -------------
 
 /**
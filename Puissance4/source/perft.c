@@ -0,0 +1,474 @@
+/**
+ * @file perft.c
+ *
+ * @author Alyssia Kayembe S211023 & Jiaxiang Yao S214174
+ *
+ * @brief Program counting the sequences of legal moves of a Connect 4 from a
+ *  position (without any window)
+ *
+ * @remark Every sequence of at most D moves is played with make_move() on
+ * the columns whose casesLeft isn't -1, and stops at the end of the game (a
+ * Connect 4 found by check_alignment() or a full grid). The number of
+ * positions reached after each number of moves is exact: 7, 49, 343, 2401,
+ * 16807, 117649, 823536, 5673234... from the empty grid of 6x7, and any other
+ * representation of the grid must give the same counts. The columns of the
+ * first move can be shared by several threads, each one with its copy of the
+ * model. With -v, every move is also checked on the grid of Colour given by
+ * get_grid() (much slower).
+ *
+ * @date 18-10-26
+ */
+
+//sysconf
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "model.h"
+#include "timing.h"
+
+/**
+ * @brief Implementation of the counts of the positions after each move
+ */
+typedef struct counter_t{
+   unsigned depth;
+   //positions reached after ply + 1 moves
+   unsigned long long *nodes;
+   //positions of these ones won by the last move
+   unsigned long long *wins;
+   //positions of these ones with a full grid (and no Connect 4)
+   unsigned long long *draws;
+   //moves for which the grid of Colour doesn't agree (with -v)
+   unsigned long long errors;
+}Counter;
+
+/**
+ * @brief Implementation of the data shared by the threads
+ */
+typedef struct perft_t{
+   Model *mp;
+   unsigned depth;
+   int verify;
+   //next column of the first move (shared by the threads)
+   unsigned next;
+   //counts of every thread, protected by the lock
+   pthread_mutex_t lock;
+   Counter total;
+   //1 if a thread couldn't count its moves
+   int failed;
+}Perft;
+
+//_________DECLARATION OF THE STATIC FUNCTIONS____________
+
+/**
+ * @brief Creates the counts of the positions, all 0
+ *
+ * @param counter the counts.
+ * @param depth number of moves counted.
+ *
+ * @pre counter != NULL, depth > 0
+ * @post returns 1 if the counts have been created, -1 otherwise.
+ */
+static int create_counter(Counter *counter, unsigned depth);
+
+/**
+ * @brief Frees the counts of the positions
+ *
+ * @param counter the counts.
+ *
+ * @pre counter != NULL
+ * @post the arrays are freed.
+ */
+static void free_counter(Counter *counter);
+
+/**
+ * @brief Counts the positions reached from the one of the model
+ *
+ * @param mp pointer on the model (in the same position at the end).
+ * @param ply number of moves already played since the first position.
+ * @param counter the counts.
+ * @param verify 1 if every move is checked on the grid of Colour.
+ *
+ * @pre mp != NULL, counter != NULL, ply < counter->depth, the game isn't over
+ * @post the positions after ply + 1 moves or more are counted.
+ */
+static void count_nodes(Model *mp, unsigned ply, Counter *counter,
+ int verify);
+
+/**
+ * @brief Plays a move, counts the position and the ones after it, then takes
+ *  the move back
+ *
+ * @param mp pointer on the model.
+ * @param column column of the move.
+ * @param ply number of moves already played since the first position.
+ * @param counter the counts.
+ * @param verify 1 if the move is checked on the grid of Colour.
+ *
+ * @pre mp != NULL, counter != NULL, ply < counter->depth, the column isn't
+ * full
+ * @post the model is in the same position as before.
+ */
+static void count_move(Model *mp, unsigned column, unsigned ply,
+ Counter *counter, int verify);
+
+/**
+ * @brief Checks the last move on the grid of Colour given by get_grid()
+ *
+ * @param mp pointer on the model.
+ * @param row row of the token placed.
+ * @param column column of the token placed.
+ * @param won 1 if check_alignment() found a Connect 4.
+ *
+ * @pre mp != NULL, the token is the last one placed
+ * @post returns 1 if the token is right under the empty cells of its column
+ * and the grid of Colour has a Connect 4 through it only when won is 1,
+ * 0 otherwise.
+ */
+static int verify_move(Model *mp, unsigned row, unsigned column, int won);
+
+/**
+ * @brief Counts the positions of the columns of the first move given to the
+ *  thread
+ *
+ * @param data pointer on the data shared by the threads.
+ *
+ * @pre data != NULL
+ * @post the counts of the thread are added to the total.
+ */
+static void *run_worker(void *data);
+
+//________END OF THE DECLARATION__________________________
+
+int main(int argc, char *argv[]){
+
+   char *optstring = ":l:c:p:d:j:vH";
+   int option = 0;
+   int status = 0;
+
+   unsigned nbLines = 6, nbColumns = 7;
+   char *moves = "";
+   int depth = 8;
+   int nbThreads = 1;
+   int verify = 0;
+
+   while(((option = getopt(argc, argv, optstring)) != EOF) && status != -1){
+      switch(option){
+         case 'l':
+            nbLines = atoi(optarg);
+            break;
+
+         case 'c':
+            nbColumns = atoi(optarg);
+            break;
+
+         case 'p':
+            moves = optarg;
+            break;
+
+         case 'd':
+            depth = atoi(optarg);
+            break;
+
+         case 'j':
+            nbThreads = (int)((!strcmp(optarg, "0"))
+             ? sysconf(_SC_NPROCESSORS_ONLN) : atol(optarg));
+            break;
+
+         case 'v':
+            verify = 1;
+            break;
+
+         case 'H':
+            printf("AIDE OPTIONS:\n");
+            printf("-l <nombre de lignes>: nombre de lignes du plateau (6 par défaut).\n");
+            printf("-c <nombre de colonnes>: nombre de colonnes du plateau (7 par défaut).\n");
+            printf("-p <coups>: position de départ, colonnes numérotées à partir de 1 (\"4453\", \"10,11\" au-delà de 9 colonnes).\n");
+            printf("-d <profondeur>: nombre de coups comptés (8 par défaut).\n");
+            printf("-j <nombre de threads>: threads se partageant le premier coup (1 par défaut, 0 pour tous les coeurs).\n");
+            printf("-v: vérifie chaque coup sur la grille de Colour (lent).\n");
+            return EXIT_SUCCESS;
+
+         case '?':
+            printf("Option inconnue: %c\n", optopt);
+            status = -1;
+            break;
+
+         case ':':
+            printf("Argument manquant: %c\n", optopt);
+            status = -1;
+            break;
+
+         default:
+            printf("Une erreur inconnue s'est produite\n");
+            status = -1;
+            break;
+      }
+   }
+
+   if(status == -1){
+      printf("Une erreur au niveau des options est survenue!\n");
+      return EXIT_FAILURE;
+   }
+
+   if(nbLines < 4 || nbLines > 100 || nbColumns < 4 || nbColumns > 100
+    || depth < 1 || nbThreads < 1){
+      printf("Les options choisies sont invalides.\n");
+      return EXIT_FAILURE;
+   }
+
+   Model *mp = create_model(nbLines, nbColumns);
+   if(mp == NULL){
+      printf("Mémoire insuffisante.\n");
+      return EXIT_FAILURE;
+   }
+   //the positions are only counted
+   set_table_size(mp, 0);
+
+   if(play_moves(mp, moves) == -1){
+      printf("Les coups \"%s\" ne forment pas une partie valide.\n", moves);
+      free_model(mp);
+      return EXIT_FAILURE;
+   }
+
+   //no more moves than cells left
+   const unsigned NBMOVES = get_nb_moves(mp);
+   if((unsigned)depth > nbLines * nbColumns - NBMOVES){
+      depth = (int)(nbLines * nbColumns - NBMOVES);
+   }
+
+   //the game may already be over
+   int over = (depth == 0);
+   if(!over && NBMOVES > 0){
+      const unsigned LAST = get_move(mp, NBMOVES - 1);
+      over = check_alignment(mp, (unsigned)(get_cases_left(mp)[LAST] + 1),
+       LAST);
+   }
+
+   Perft p;
+   memset(&p, 0, sizeof(Perft));
+   p.mp = mp;
+   p.depth = (unsigned)depth;
+   p.verify = verify;
+   if(over){
+      //nothing to count: every count stays 0
+      p.next = nbColumns;
+      p.depth = 1;
+   }
+   if(create_counter(&p.total, p.depth) == -1){
+      printf("Mémoire insuffisante.\n");
+      free_model(mp);
+      return EXIT_FAILURE;
+   }
+   pthread_mutex_init(&p.lock, NULL);
+
+   printf("Position \"%s\" (%u coups), plateau %ux%u, profondeur %d, "
+    "%d thread(s)%s\n", moves, NBMOVES, nbLines, nbColumns, depth, nbThreads,
+    verify ? ", vérification" : "");
+   fflush(stdout);
+
+   const double START = get_time();
+
+   //no more threads than columns
+   if((unsigned)nbThreads > nbColumns){
+      nbThreads = (int)nbColumns;
+   }
+   pthread_t *threads = NULL;
+   int nbStarted = 0;
+   if(nbThreads > 1){
+      threads = malloc(sizeof(pthread_t) * nbThreads);
+   }
+   if(threads != NULL){
+      while(nbStarted < nbThreads
+       && !pthread_create(&threads[nbStarted], NULL, run_worker, &p)){
+         ++nbStarted;
+      }
+   }
+   //without any other thread, the main one counts everything
+   if(nbStarted == 0){
+      run_worker(&p);
+   }
+   for(int i = 0; i < nbStarted; ++i){
+      pthread_join(threads[i], NULL);
+   }
+   free(threads);
+
+   const double SECONDS = get_time() - START;
+   pthread_mutex_destroy(&p.lock);
+
+   if(p.failed){
+      printf("Mémoire insuffisante.\n");
+      status = -1;
+   }
+   else{
+      unsigned long long total = 0;
+      printf("%10s %20s %16s %12s\n", "profondeur", "positions", "victoires",
+       "nuls");
+      for(unsigned d = 0; d < p.depth; ++d){
+         printf("%10u %20llu %16llu %12llu\n", d + 1, p.total.nodes[d],
+          p.total.wins[d], p.total.draws[d]);
+         total += p.total.nodes[d];
+      }
+      printf("%llu positions en %.3f s, %.0f positions/s\n", total, SECONDS,
+       (SECONDS > 0) ? total / SECONDS : 0.0);
+
+      if(verify){
+         printf("Vérification: %llu erreur(s)\n", p.total.errors);
+         if(p.total.errors > 0){
+            status = -1;
+         }
+      }
+   }
+
+   free_counter(&p.total);
+   free_model(mp);
+
+   return (status == -1) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// ----------- STATIC FUNCTIONS --------------------
+
+static int create_counter(Counter *counter, unsigned depth){
+   assert(counter != NULL && depth > 0);
+
+   counter->depth = depth;
+   counter->nodes = calloc(3 * depth, sizeof(unsigned long long));
+   if(counter->nodes == NULL){
+      return -1;
+   }
+   counter->wins = counter->nodes + depth;
+   counter->draws = counter->wins + depth;
+   counter->errors = 0;
+
+   return 1;
+}
+
+static void free_counter(Counter *counter){
+   assert(counter != NULL);
+
+   free(counter->nodes);
+   counter->nodes = NULL;
+}
+
+static void count_nodes(Model *mp, unsigned ply, Counter *counter,
+ int verify){
+   assert(mp != NULL && counter != NULL && ply < counter->depth);
+
+   const int *casesLeft = get_cases_left(mp);
+   const unsigned NBCOLUMNS = get_nbColumns(mp);
+
+   for(unsigned j = 0; j < NBCOLUMNS; ++j){
+      if(casesLeft[j] >= 0){
+         count_move(mp, j, ply, counter, verify);
+      }
+   }
+}
+
+static void count_move(Model *mp, unsigned column, unsigned ply,
+ Counter *counter, int verify){
+   assert(mp != NULL && counter != NULL && ply < counter->depth);
+
+   const unsigned ROW = make_move(mp, column);
+   const int WON = check_alignment(mp, ROW, column);
+   ++counter->nodes[ply];
+
+   if(verify && !verify_move(mp, ROW, column, WON)){
+      ++counter->errors;
+   }
+
+   if(WON){
+      ++counter->wins[ply];
+   }
+   else if(get_nb_moves(mp) == get_nbLines(mp) * get_nbColumns(mp)){
+      ++counter->draws[ply];
+   }
+   else if(ply + 1 < counter->depth){
+      count_nodes(mp, ply + 1, counter, verify);
+   }
+
+   unmake_move(mp, column);
+}
+
+static int verify_move(Model *mp, unsigned row, unsigned column, int won){
+   assert(mp != NULL);
+
+   Colour **grid = get_grid(mp);
+   const int NBLINES = (int)get_nbLines(mp);
+   const int NBCOLUMNS = (int)get_nbColumns(mp);
+   const int ROW = (int)row;
+   const int COLUMN = (int)column;
+   const Colour COLOUR = grid[ROW][COLUMN];
+
+   //the token lies on the bottom or on another token, under an empty cell
+   if(COLOUR == none || get_cases_left(mp)[column] != ROW - 1
+    || (ROW + 1 < NBLINES && grid[ROW + 1][COLUMN] == none)
+    || (ROW > 0 && grid[ROW - 1][COLUMN] != none)){
+      return 0;
+   }
+
+   //the tokens in a row are counted in the four directions
+   const int DIRECTIONS[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+   int aligned = 0;
+   for(unsigned d = 0; d < 4 && !aligned; ++d){
+      int count = 1;
+      for(int sign = -1; sign <= 1; sign += 2){
+         int i = ROW + sign * DIRECTIONS[d][0];
+         int j = COLUMN + sign * DIRECTIONS[d][1];
+         while(i >= 0 && i < NBLINES && j >= 0 && j < NBCOLUMNS
+          && grid[i][j] == COLOUR){
+            ++count;
+            i += sign * DIRECTIONS[d][0];
+            j += sign * DIRECTIONS[d][1];
+         }
+      }
+      aligned = (count >= 4);
+   }
+
+   return aligned == (won != 0);
+}
+
+static void *run_worker(void *data){
+   assert(data != NULL);
+
+   Perft *p = data;
+
+   //every thread plays on its own copy
+   Model *copy = duplicate_model(p->mp);
+   Counter counter;
+   if(copy == NULL || create_counter(&counter, p->depth) == -1){
+      free_model(copy);
+      pthread_mutex_lock(&p->lock);
+      p->failed = 1;
+      pthread_mutex_unlock(&p->lock);
+      return NULL;
+   }
+
+   const int *casesLeft = get_cases_left(copy);
+   const unsigned NBCOLUMNS = get_nbColumns(copy);
+   unsigned column;
+   while((column = __atomic_fetch_add(&p->next, 1, __ATOMIC_RELAXED))
+    < NBCOLUMNS){
+      if(casesLeft[column] >= 0){
+         count_move(copy, column, 0, &counter, p->verify);
+      }
+   }
+
+   pthread_mutex_lock(&p->lock);
+   for(unsigned d = 0; d < p->depth; ++d){
+      p->total.nodes[d] += counter.nodes[d];
+      p->total.wins[d] += counter.wins[d];
+      p->total.draws[d] += counter.draws[d];
+   }
+   p->total.errors += counter.errors;
+   pthread_mutex_unlock(&p->lock);
+
+   free_counter(&counter);
+   free_model(copy);
+   return NULL;
+}
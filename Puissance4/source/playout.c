@@ -0,0 +1,573 @@
+/**
+ * @file playout.c
+ *
+ * @author Alyssia Kayembe S211023 & Jiaxiang Yao S214174
+ *
+ * @brief File implementing the kernel playing many random games of a
+ *  Connect 4 at once
+ *
+ * @date 18-10-26
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "model.h"
+#include "playout.h"
+#include "grid.h"
+#include "bitboard.h"
+
+//Number of games whose random numbers are kept on the stack (multiple of 4)
+#define GROUP_GAMES 64
+
+#ifdef VECTOR_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Implementation of the position the games start from
+ *
+ * @remark Same layout as bitboard.h: column after column, nbLines + 1 bits
+ * per column, the lowest cell first. The extra bit of each column stays
+ * empty, so that the shifts never align tokens of two different columns.
+ */
+typedef struct board_t{
+   //tokens of the colour whose turn it is
+   uint64_t own;
+   //all the tokens
+   uint64_t mask;
+   //all the cells of the grid
+   uint64_t full;
+   //cells of the first column
+   uint64_t column;
+   unsigned nbColumns;
+   //nbLines + 1
+   unsigned height;
+   //colour whose turn it is
+   Colour colour;
+}Board;
+
+//_________DECLARATION OF THE STATIC FUNCTIONS_____________
+
+/**
+ * @brief Tells if the grid of a model fits in the bitboards of 64 bits
+ *
+ * @param mp pointer on the model.
+ *
+ * @pre mp != NULL
+ * @post returns 1 if it does, 0 otherwise.
+ */
+static int fits_in_word(Model *mp);
+
+/**
+ * @brief Reads the position of a model into a board
+ *
+ * @param mp pointer on the model.
+ * @param b pointer on the board.
+ *
+ * @pre mp != NULL, b != NULL, fits_in_word(mp)
+ * @post the board is filled.
+ */
+static void read_board(Model *mp, Board *b);
+
+/**
+ * @brief Tells if there are four tokens in a row in a bitboard of 64 bits
+ *
+ * @param tokens the bitboard.
+ * @param height number of bits per column.
+ *
+ * @pre /
+ * @post returns something else than 0 if there are.
+ */
+static uint64_t aligns_four_word(uint64_t tokens, unsigned height);
+
+/**
+ * @brief Gives a random number (xorshift64)
+ *
+ * @param state pointer on the state of the generator.
+ *
+ * @pre state != NULL, *state != 0
+ * @post returns a random number.
+ */
+static uint64_t next_random(uint64_t *state);
+
+/**
+ * @brief Gives the seed of the random numbers of a game (splitmix64)
+ *
+ * @remark The games can't take successive numbers of the same xorshift:
+ * their sequences would only be shifted by one number.
+ *
+ * @param state pointer on the state of the generator.
+ *
+ * @pre state != NULL
+ * @post returns a seed.
+ */
+static uint64_t next_seed(uint64_t *state);
+
+/**
+ * @brief Plays random games one after another on bitboards of 64 bits
+ *
+ * @param b pointer on the starting position.
+ * @param nbGames number of games.
+ * @param seeds one state of the random numbers per game.
+ * @param outcomes array that will store the colour who won each game.
+ *
+ * @pre b != NULL, seeds != NULL, outcomes != NULL
+ * @post the outcomes are stored.
+ */
+static void play_games_scalar(const Board *b, unsigned nbGames,
+ uint64_t *seeds, Colour *outcomes);
+
+#ifdef VECTOR_X86
+/**
+ * @brief Plays random games two at a time (SSE2)
+ *
+ * @param b pointer on the starting position.
+ * @param nbGames number of games (a multiple of 2).
+ * @param seeds one state of the random numbers per game.
+ * @param outcomes array that will store the colour who won each game.
+ *
+ * @pre b != NULL, seeds != NULL, outcomes != NULL, the processor has SSE2
+ * @post the outcomes are stored.
+ */
+static void play_games_sse2(const Board *b, unsigned nbGames,
+ uint64_t *seeds, Colour *outcomes);
+
+/**
+ * @brief Plays random games four at a time (AVX2)
+ *
+ * @param b pointer on the starting position.
+ * @param nbGames number of games (a multiple of 4).
+ * @param seeds one state of the random numbers per game.
+ * @param outcomes array that will store the colour who won each game.
+ *
+ * @pre b != NULL, seeds != NULL, outcomes != NULL, the processor has AVX2
+ * @post the outcomes are stored.
+ */
+static void play_games_avx2(const Board *b, unsigned nbGames,
+ uint64_t *seeds, Colour *outcomes);
+#endif
+
+/**
+ * @brief Plays random games one after another on the model itself (grids
+ *  too big for 64 bits)
+ *
+ * @param mp pointer on the model.
+ * @param nbGames number of games.
+ * @param random pointer on the state of the random numbers.
+ * @param outcomes array that will store the colour who won each game.
+ *
+ * @pre mp != NULL, random != NULL, outcomes != NULL
+ * @post the outcomes are stored, the model is in the same state as before.
+ */
+static void play_games_model(Model *mp, unsigned nbGames, uint64_t *random,
+ Colour *outcomes);
+
+//________END OF THE DECLARATION__________________________
+
+void play_random_games(Model *mp, unsigned nbGames, uint64_t *random,
+ Colour *outcomes){
+   assert(mp != NULL && random != NULL && *random != 0 && outcomes != NULL);
+
+   if(nbGames == 0){
+      return;
+   }
+   if(!fits_in_word(mp)){
+      play_games_model(mp, nbGames, random, outcomes);
+      return;
+   }
+
+   Board b;
+   read_board(mp, &b);
+
+   //the games are played by groups, the vector kernels need whole vectors
+   uint64_t seeds[GROUP_GAMES];
+   Colour results[GROUP_GAMES];
+   for(unsigned first = 0; first < nbGames; first += GROUP_GAMES){
+      unsigned nbPlayed = nbGames - first;
+      if(nbPlayed > GROUP_GAMES){
+         nbPlayed = GROUP_GAMES;
+      }
+      //the extra games of the last vector are dropped
+      const unsigned NBLANES = (nbPlayed + 3) & ~3u;
+      for(unsigned i = 0; i < NBLANES; ++i){
+         //xorshift must never be given 0
+         seeds[i] = next_seed(random) | 1;
+      }
+
+#ifdef VECTOR_X86
+      if(__builtin_cpu_supports("avx2")){
+         play_games_avx2(&b, NBLANES, seeds, results);
+      }
+      else if(__builtin_cpu_supports("sse2")){
+         play_games_sse2(&b, NBLANES, seeds, results);
+      }
+      else{
+         play_games_scalar(&b, nbPlayed, seeds, results);
+      }
+#else
+      play_games_scalar(&b, nbPlayed, seeds, results);
+#endif
+
+      for(unsigned i = 0; i < nbPlayed; ++i){
+         outcomes[first + i] = results[i];
+      }
+   }
+}
+
+const char *get_playout_kernel(Model *mp){
+   assert(mp != NULL);
+
+   if(!fits_in_word(mp)){
+      return "model";
+   }
+#ifdef VECTOR_X86
+   if(__builtin_cpu_supports("avx2")){
+      return "avx2";
+   }
+   if(__builtin_cpu_supports("sse2")){
+      return "sse2";
+   }
+#endif
+   return "scalar";
+}
+
+// ----------- STATIC FUNCTIONS --------------------
+
+static int fits_in_word(Model *mp){
+   assert(mp != NULL);
+
+   return (get_nbLines(mp) + 1) * get_nbColumns(mp) <= 64;
+}
+
+static void read_board(Model *mp, Board *b){
+   assert(mp != NULL && b != NULL);
+
+   const unsigned NBLINES = get_nbLines(mp);
+   const unsigned NBCOLUMNS = get_nbColumns(mp);
+   const PackedGrid *grid = get_packed_grid(mp);
+
+   b->nbColumns = NBCOLUMNS;
+   b->height = NBLINES + 1;
+   b->colour = get_side_to_move(mp);
+   b->column = (UINT64_C(1) << NBLINES) - 1;
+   b->own = 0;
+   b->mask = 0;
+   b->full = 0;
+
+   for(unsigned j = 0; j < NBCOLUMNS; ++j){
+      b->full |= b->column << (j * b->height);
+      for(unsigned i = 0; i < NBLINES; ++i){
+         //the lowest line of the grid is the first bit of the column
+         uint64_t bit = UINT64_C(1) << (j * b->height + NBLINES - 1 - i);
+         Colour colour = get_packed_cell(grid, i, j);
+         if(colour != none){
+            b->mask |= bit;
+         }
+         if(colour == b->colour){
+            b->own |= bit;
+         }
+      }
+   }
+}
+
+static uint64_t aligns_four_word(uint64_t tokens, unsigned height){
+   //vertical, horizontal and both diagonals
+   const unsigned SHIFTS[4] = {1, height, height - 1, height + 1};
+
+   uint64_t found = 0;
+   for(unsigned k = 0; k < 4; ++k){
+      uint64_t pairs = tokens & (tokens >> SHIFTS[k]);
+      found |= pairs & (pairs >> (2 * SHIFTS[k]));
+   }
+
+   return found;
+}
+
+static uint64_t next_random(uint64_t *state){
+   assert(state != NULL);
+
+   *state ^= *state << 13;
+   *state ^= *state >> 7;
+   *state ^= *state << 17;
+   return *state;
+}
+
+static uint64_t next_seed(uint64_t *state){
+   assert(state != NULL);
+
+   uint64_t z = (*state += UINT64_C(0x9E3779B97F4A7C15));
+   z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+   z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+   return z ^ (z >> 31);
+}
+
+static void play_games_scalar(const Board *b, unsigned nbGames,
+ uint64_t *seeds, Colour *outcomes){
+   assert(b != NULL && seeds != NULL && outcomes != NULL);
+
+   const Colour OTHER = (b->colour == red) ? yellow : red;
+
+   for(unsigned g = 0; g < nbGames; ++g){
+      uint64_t own = b->own;
+      uint64_t mask = b->mask;
+      Colour mover = b->colour;
+      outcomes[g] = none;
+
+      while(mask != b->full){
+         //a column picked in a full column is picked again
+         uint64_t column = ((next_random(&seeds[g]) >> 32) * b->nbColumns) >> 32;
+         unsigned shift = (unsigned)column * b->height;
+         uint64_t move = (mask + (UINT64_C(1) << shift)) & (b->column << shift);
+         if(move == 0){
+            continue;
+         }
+
+         own |= move;
+         mask |= move;
+         if(aligns_four_word(own, b->height)){
+            outcomes[g] = mover;
+            break;
+         }
+
+         //the tokens of the other colour
+         own ^= mask;
+         mover = (mover == b->colour) ? OTHER : b->colour;
+      }
+   }
+}
+
+#ifdef VECTOR_X86
+/**
+ * @brief Gives all ones in the 64-bit lanes equal to zero (SSE2 has no 64-bit
+ *  comparison)
+ */
+__attribute__((target("sse2")))
+static inline __m128i is_zero_sse2(__m128i x){
+   __m128i equal = _mm_cmpeq_epi32(x, _mm_setzero_si128());
+   return _mm_and_si128(equal, _mm_shuffle_epi32(equal, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+
+/**
+ * @brief Shifts each 64-bit lane left by its own count (SSE2 only shifts both
+ *  lanes by the same count)
+ */
+__attribute__((target("sse2")))
+static inline __m128i shift_left_sse2(__m128i x, __m128i counts){
+   __m128i low = _mm_sll_epi64(x, counts);
+   __m128i high = _mm_sll_epi64(x, _mm_unpackhi_epi64(counts, counts));
+   return _mm_castpd_si128(_mm_move_sd(_mm_castsi128_pd(high),
+    _mm_castsi128_pd(low)));
+}
+
+__attribute__((target("sse2")))
+static void play_games_sse2(const Board *b, unsigned nbGames,
+ uint64_t *seeds, Colour *outcomes){
+   assert(b != NULL && seeds != NULL && outcomes != NULL && nbGames % 2 == 0);
+
+   const Colour OTHER = (b->colour == red) ? yellow : red;
+   const __m128i ONE = _mm_set1_epi64x(1);
+   const __m128i TWO = _mm_set1_epi64x(2);
+   const __m128i COLUMN = _mm_set1_epi64x((long long)b->column);
+   const __m128i FULL = _mm_set1_epi64x((long long)b->full);
+   const __m128i NBCOLUMNS = _mm_set1_epi64x(b->nbColumns);
+   const __m128i HEIGHT = _mm_set1_epi64x(b->height);
+   const __m128i ALL = _mm_set1_epi64x(-1);
+   __m128i shifts[4];
+   shifts[0] = _mm_cvtsi32_si128(1);
+   shifts[1] = _mm_cvtsi32_si128((int)b->height);
+   shifts[2] = _mm_cvtsi32_si128((int)b->height - 1);
+   shifts[3] = _mm_cvtsi32_si128((int)b->height + 1);
+
+   for(unsigned g = 0; g < nbGames; g += 2){
+      __m128i random = _mm_loadu_si128((const __m128i *)&seeds[g]);
+      __m128i own = _mm_set1_epi64x((long long)b->own);
+      __m128i mask = _mm_set1_epi64x((long long)b->mask);
+      //all ones in the lanes whose turn is the one of the other colour
+      __m128i side = _mm_setzero_si128();
+      __m128i done = is_zero_sse2(_mm_xor_si128(mask, FULL));
+      __m128i won = _mm_setzero_si128();
+
+      while(_mm_movemask_epi8(done) != 0xFFFF){
+         random = _mm_xor_si128(random, _mm_slli_epi64(random, 13));
+         random = _mm_xor_si128(random, _mm_srli_epi64(random, 7));
+         random = _mm_xor_si128(random, _mm_slli_epi64(random, 17));
+
+         //column = (high 32 bits * nbColumns) >> 32, then its first bit
+         __m128i column = _mm_srli_epi64(
+          _mm_mul_epu32(_mm_srli_epi64(random, 32), NBCOLUMNS), 32);
+         __m128i shift = _mm_mul_epu32(column, HEIGHT);
+         __m128i move = _mm_and_si128(
+          _mm_add_epi64(mask, shift_left_sse2(ONE, shift)),
+          shift_left_sse2(COLUMN, shift));
+         move = _mm_andnot_si128(done, move);
+         __m128i moved = _mm_andnot_si128(is_zero_sse2(move), ALL);
+
+         __m128i tokens = _mm_or_si128(own, move);
+         mask = _mm_or_si128(mask, move);
+
+         __m128i found = _mm_setzero_si128();
+         for(unsigned k = 0; k < 4; ++k){
+            __m128i pairs = _mm_and_si128(tokens, _mm_srl_epi64(tokens, shifts[k]));
+            found = _mm_or_si128(found, _mm_and_si128(pairs,
+             _mm_srl_epi64(pairs, _mm_add_epi64(shifts[k], shifts[k]))));
+         }
+         __m128i win = _mm_andnot_si128(is_zero_sse2(found), moved);
+         __m128i draw = _mm_and_si128(is_zero_sse2(_mm_xor_si128(mask, FULL)),
+          moved);
+
+         won = _mm_or_si128(won, _mm_and_si128(win, _mm_or_si128(
+          _mm_and_si128(side, ONE), _mm_andnot_si128(side, TWO))));
+         done = _mm_or_si128(done, _mm_or_si128(win, draw));
+
+         //the lanes that played give the turn to the other colour
+         own = _mm_or_si128(_mm_and_si128(moved, _mm_xor_si128(tokens, mask)),
+          _mm_andnot_si128(moved, own));
+         side = _mm_xor_si128(side, moved);
+      }
+
+      _mm_storeu_si128((__m128i *)&seeds[g], random);
+      uint64_t results[2];
+      _mm_storeu_si128((__m128i *)results, won);
+      for(unsigned i = 0; i < 2; ++i){
+         //2: the colour whose turn it was won, 1: the other one
+         outcomes[g + i] = (results[i] & 2) ? b->colour
+          : (results[i] & 1) ? OTHER : none;
+      }
+   }
+}
+
+__attribute__((target("avx2")))
+static void play_games_avx2(const Board *b, unsigned nbGames,
+ uint64_t *seeds, Colour *outcomes){
+   assert(b != NULL && seeds != NULL && outcomes != NULL && nbGames % 4 == 0);
+
+   const Colour OTHER = (b->colour == red) ? yellow : red;
+   const __m256i ZERO = _mm256_setzero_si256();
+   const __m256i ONE = _mm256_set1_epi64x(1);
+   const __m256i TWO = _mm256_set1_epi64x(2);
+   const __m256i COLUMN = _mm256_set1_epi64x((long long)b->column);
+   const __m256i FULL = _mm256_set1_epi64x((long long)b->full);
+   const __m256i NBCOLUMNS = _mm256_set1_epi64x(b->nbColumns);
+   const __m256i HEIGHT = _mm256_set1_epi64x(b->height);
+   const int SHIFTS[4] = {1, (int)b->height, (int)b->height - 1,
+    (int)b->height + 1};
+
+   for(unsigned g = 0; g < nbGames; g += 4){
+      __m256i random = _mm256_loadu_si256((const __m256i *)&seeds[g]);
+      __m256i own = _mm256_set1_epi64x((long long)b->own);
+      __m256i mask = _mm256_set1_epi64x((long long)b->mask);
+      //all ones in the lanes whose turn is the one of the other colour
+      __m256i side = ZERO;
+      __m256i done = _mm256_cmpeq_epi64(mask, FULL);
+      __m256i won = ZERO;
+
+      while(_mm256_movemask_epi8(done) != -1){
+         random = _mm256_xor_si256(random, _mm256_slli_epi64(random, 13));
+         random = _mm256_xor_si256(random, _mm256_srli_epi64(random, 7));
+         random = _mm256_xor_si256(random, _mm256_slli_epi64(random, 17));
+
+         //column = (high 32 bits * nbColumns) >> 32, then its first bit
+         __m256i column = _mm256_srli_epi64(
+          _mm256_mul_epu32(_mm256_srli_epi64(random, 32), NBCOLUMNS), 32);
+         __m256i shift = _mm256_mul_epu32(column, HEIGHT);
+         __m256i move = _mm256_and_si256(
+          _mm256_add_epi64(mask, _mm256_sllv_epi64(ONE, shift)),
+          _mm256_sllv_epi64(COLUMN, shift));
+         move = _mm256_andnot_si256(done, move);
+         __m256i stuck = _mm256_cmpeq_epi64(move, ZERO);
+
+         __m256i tokens = _mm256_or_si256(own, move);
+         mask = _mm256_or_si256(mask, move);
+
+         __m256i found = ZERO;
+         for(unsigned k = 0; k < 4; ++k){
+            __m256i pairs = _mm256_and_si256(tokens,
+             _mm256_srli_epi64(tokens, SHIFTS[k]));
+            found = _mm256_or_si256(found, _mm256_and_si256(pairs,
+             _mm256_srli_epi64(pairs, 2 * SHIFTS[k])));
+         }
+         __m256i win = _mm256_andnot_si256(stuck,
+          _mm256_xor_si256(_mm256_cmpeq_epi64(found, ZERO),
+          _mm256_set1_epi64x(-1)));
+         __m256i draw = _mm256_andnot_si256(stuck,
+          _mm256_cmpeq_epi64(mask, FULL));
+
+         won = _mm256_or_si256(won, _mm256_and_si256(win,
+          _mm256_blendv_epi8(TWO, ONE, side)));
+         done = _mm256_or_si256(done, _mm256_or_si256(win, draw));
+
+         //the lanes that played give the turn to the other colour
+         own = _mm256_blendv_epi8(_mm256_xor_si256(tokens, mask), own, stuck);
+         side = _mm256_xor_si256(side, _mm256_andnot_si256(stuck,
+          _mm256_set1_epi64x(-1)));
+      }
+
+      _mm256_storeu_si256((__m256i *)&seeds[g], random);
+      uint64_t results[4];
+      _mm256_storeu_si256((__m256i *)results, won);
+      for(unsigned i = 0; i < 4; ++i){
+         //2: the colour whose turn it was won, 1: the other one
+         outcomes[g + i] = (results[i] & 2) ? b->colour
+          : (results[i] & 1) ? OTHER : none;
+      }
+   }
+}
+#endif
+
+static void play_games_model(Model *mp, unsigned nbGames, uint64_t *random,
+ Colour *outcomes){
+   assert(mp != NULL && random != NULL && outcomes != NULL);
+
+   const unsigned NBCOLUMNS = get_nbColumns(mp);
+   const unsigned CELLSLEFT =
+    get_nbLines(mp) * NBCOLUMNS - get_nb_moves(mp);
+
+   unsigned *moves = malloc(sizeof(unsigned) * (CELLSLEFT + 1));
+   unsigned *columns = malloc(sizeof(unsigned) * NBCOLUMNS);
+   if(moves == NULL || columns == NULL){
+      free(moves);
+      free(columns);
+      for(unsigned g = 0; g < nbGames; ++g){
+         outcomes[g] = none;
+      }
+      return;
+   }
+
+   for(unsigned g = 0; g < nbGames; ++g){
+      unsigned nbColumns = 0;
+      for(unsigned i = 0; i < NBCOLUMNS; ++i){
+         if(!check_height(mp, i)){
+            columns[nbColumns++] = i;
+         }
+      }
+
+      Colour winner = none;
+      unsigned nbMoves = 0;
+      while(nbColumns > 0 && winner == none){
+         unsigned k = (unsigned)(((next_random(random) >> 32) * nbColumns) >> 32);
+         unsigned column = columns[k];
+
+         Colour colour = get_side_to_move(mp);
+         unsigned row = make_move(mp, column);
+         moves[nbMoves++] = column;
+
+         if(check_alignment(mp, row, column)){
+            winner = colour;
+         }
+         //a full column is replaced by the last one of the array
+         if(check_height(mp, column)){
+            columns[k] = columns[--nbColumns];
+         }
+      }
+
+      while(nbMoves > 0){
+         unmake_move(mp, moves[--nbMoves]);
+      }
+      outcomes[g] = winner;
+   }
+
+   free(moves);
+   free(columns);
+}
@@ -0,0 +1,60 @@
+/**
+ * @file playout.h
+ *
+ * @author Alyssia Kayembe S211023 & Jiaxiang Yao S214174
+ *
+ * @brief Header of the file containing the kernel playing many random games
+ *  of a Connect 4 at once
+ *
+ * @remark When a grid fits in 64 bits (one bit per cell plus one per column,
+ * up to 7x8 or 6x9 for instance), every game is a pair of 64-bit bitboards
+ * and the games advance in lockstep, one per lane of a vector: each lane
+ * picks a random column, drops its token and looks for four in a row at the
+ * same time as the others. The kernel is chosen when the program runs: AVX2
+ * (4 games at once), SSE2 (2 games) or plain C (1 game) on the other
+ * processors. The bigger grids are played one game after another on the
+ * model itself (make_move()/unmake_move()).
+ *
+ * @date 18-10-26
+ */
+
+#ifndef ___PLAYOUT___
+#define ___PLAYOUT___
+
+#include <stdint.h>
+
+#include "model.h"
+
+/**
+ * @brief Plays random games from the current position of a model
+ *
+ * @remark Every move of a game is a column picked uniformly among the ones
+ * that aren't full, until a colour aligns four tokens or the grid is full.
+ *
+ * @param mp pointer on the model.
+ * @param nbGames number of games.
+ * @param random pointer on the state of the random numbers (anything but 0,
+ * updated by the function).
+ * @param outcomes array that will store the colour who won each game, none
+ * for a draw (nbGames elements).
+ *
+ * @pre mp != NULL, random != NULL, *random != 0, outcomes != NULL, the game
+ * isn't over
+ * @post the outcomes are stored, the model is in the same state as before.
+ */
+void play_random_games(Model *mp, unsigned nbGames, uint64_t *random,
+ Colour *outcomes);
+
+/**
+ * @brief Gives the name of the kernel that play_random_games() uses for the
+ *  grid of a model
+ *
+ * @param mp pointer on the model.
+ *
+ * @pre mp != NULL
+ * @post returns "avx2", "sse2", "scalar" or "model" (grid too big for the
+ * bitboards of 64 bits).
+ */
+const char *get_playout_kernel(Model *mp);
+
+#endif //___PLAYOUT___
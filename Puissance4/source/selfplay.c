@@ -0,0 +1,458 @@
+/**
+ * @file selfplay.c
+ *
+ * @author Alyssia Kayembe S211023 & Jiaxiang Yao S214174
+ *
+ * @brief Program making two "A.I." of a Connect 4 play against each other
+ *  (without any window)
+ *
+ * @remark Each computer has its own model, in which the other computer is the
+ * player: the column chosen by one is played with play_token_ai() in its
+ * model and with add_token_player() in the other one. The games are shared
+ * by several threads, the two computers starting in turn. The program gives
+ * the results of the first computer, the number of games and moves per
+ * second and the distribution of the time taken by each move.
+ *
+ * @date 18-10-26
+ */
+
+//sysconf
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "model.h"
+#include "timing.h"
+
+//first size of the array of the times of a thread
+#define LATENCIES_START 1024
+
+/**
+ * @brief Implementation of the data shared by the threads of the games
+ */
+typedef struct tournament_t{
+   unsigned nbLines;
+   unsigned nbColumns;
+   unsigned nbGames;
+   //level of each computer
+   Level levels[2];
+   //time given to each move in ms (0: the depth of the level)
+   unsigned moveTime;
+   //size of the transposition table of each model in MB
+   int tableSize;
+   uint64_t seed;
+   //next game to play (shared by the threads)
+   unsigned next;
+   //results, protected by the lock
+   pthread_mutex_t lock;
+   unsigned wins[2];
+   unsigned draws;
+   unsigned nbPlayed;
+   unsigned long long nbMoves;
+   //time of every move in seconds
+   double *latencies;
+   size_t nbLatencies;
+   //1 if a thread couldn't play its games
+   int failed;
+}Tournament;
+
+/**
+ * @brief Implementation of a thread playing games
+ */
+typedef struct worker_t{
+   Tournament *t;
+   //model of each computer
+   Model *models[2];
+   //time of the moves played by the thread
+   double *latencies;
+   size_t nbLatencies;
+   size_t capacity;
+}Worker;
+
+//_________DECLARATION OF THE STATIC FUNCTIONS____________
+
+/**
+ * @brief Reads the name of a level
+ *
+ * @param name name of the level ("facile", "difficile" or "montecarlo").
+ * @param level a pointer that will store the level.
+ *
+ * @pre name != NULL, level != NULL
+ * @post returns 1 if the level exists, -1 otherwise.
+ */
+static int read_level(const char *name, Level *level);
+
+/**
+ * @brief Gives the name of a level
+ *
+ * @param level the level.
+ *
+ * @pre /
+ * @post returns the name used by the option of the level.
+ */
+static const char *get_level_name(Level level);
+
+/**
+ * @brief Plays the games of the tournament (in each thread)
+ *
+ * @param data pointer on the tournament.
+ *
+ * @pre data != NULL
+ * @post there isn't any game left.
+ */
+static void *run_worker(void *data);
+
+/**
+ * @brief Plays one game between the two computers
+ *
+ * @param w pointer on the thread.
+ * @param index index of the game (the first computer starts the even ones).
+ * @param nbMoves a pointer that will store the number of moves of the game.
+ *
+ * @pre w != NULL, nbMoves != NULL
+ * @post returns the index of the computer who won (0 or 1), -1 for a draw,
+ * -2 if the time of a move couldn't be saved.
+ */
+static int play_game(Worker *w, unsigned index, unsigned *nbMoves);
+
+//________END OF THE DECLARATION__________________________
+
+int main(int argc, char *argv[]){
+
+   char *optstring = ":l:c:n:j:a:b:m:t:r:H";
+   int option = 0;
+   int status = 0;
+
+   unsigned nbLines = 6, nbColumns = 7;
+   int nbGames = 100;
+   long nbThreads = sysconf(_SC_NPROCESSORS_ONLN);
+   Level levels[2] = {hard, easy};
+   int moveTime = 0;
+   int tableSize = 16;
+   uint64_t seed = (uint64_t)time(NULL);
+
+   while(((option = getopt(argc, argv, optstring)) != EOF) && status != -1){
+      switch(option){
+         case 'l':
+            nbLines = atoi(optarg);
+            break;
+
+         case 'c':
+            nbColumns = atoi(optarg);
+            break;
+
+         case 'n':
+            nbGames = atoi(optarg);
+            break;
+
+         case 'j':
+            nbThreads = atol(optarg);
+            break;
+
+         case 'a':
+            if(read_level(optarg, &levels[0]) == -1){
+               printf("Niveau inconnu: %s\n", optarg);
+               status = -1;
+            }
+            break;
+
+         case 'b':
+            if(read_level(optarg, &levels[1]) == -1){
+               printf("Niveau inconnu: %s\n", optarg);
+               status = -1;
+            }
+            break;
+
+         case 'm':
+            moveTime = atoi(optarg);
+            break;
+
+         case 't':
+            tableSize = atoi(optarg);
+            break;
+
+         case 'r':
+            seed = strtoull(optarg, NULL, 10);
+            break;
+
+         case 'H':
+            printf("AIDE OPTIONS:\n");
+            printf("-l <nombre de lignes>: nombre de lignes du plateau (6 par défaut).\n");
+            printf("-c <nombre de colonnes>: nombre de colonnes du plateau (7 par défaut).\n");
+            printf("-n <parties>: nombre de parties (100 par défaut).\n");
+            printf("-j <nombre de threads>: parties jouées en même temps (tous les coeurs par défaut).\n");
+            printf("-a <facile|difficile|montecarlo>: niveau du premier ordinateur (difficile par défaut).\n");
+            printf("-b <facile|difficile|montecarlo>: niveau du second ordinateur (facile par défaut).\n");
+            printf("-m <millisecondes>: temps de réflexion par coup (profondeur du niveau par défaut).\n");
+            printf("-t <taille en Mo>: table de transposition de chaque ordinateur (16 par défaut).\n");
+            printf("-r <graine>: graine des nombres aléatoires (l'heure par défaut).\n");
+            return EXIT_SUCCESS;
+
+         case '?':
+            printf("Option inconnue: %c\n", optopt);
+            status = -1;
+            break;
+
+         case ':':
+            printf("Argument manquant: %c\n", optopt);
+            status = -1;
+            break;
+
+         default:
+            printf("Une erreur inconnue s'est produite\n");
+            status = -1;
+            break;
+      }
+   }
+
+   if(status == -1){
+      printf("Une erreur au niveau des options est survenue!\n");
+      return EXIT_FAILURE;
+   }
+
+   if(nbLines < 4 || nbLines > 100 || nbColumns < 4 || nbColumns > 100
+    || nbGames < 1 || nbThreads < 1 || moveTime < 0 || tableSize < 0){
+      printf("Les options choisies sont invalides.\n");
+      return EXIT_FAILURE;
+   }
+
+   //no more threads than games
+   if(nbThreads > nbGames){
+      nbThreads = nbGames;
+   }
+
+   Tournament t;
+   memset(&t, 0, sizeof(Tournament));
+   t.nbLines = nbLines;
+   t.nbColumns = nbColumns;
+   t.nbGames = (unsigned)nbGames;
+   t.levels[0] = levels[0];
+   t.levels[1] = levels[1];
+   t.moveTime = (unsigned)moveTime;
+   t.tableSize = tableSize;
+   t.seed = seed;
+   pthread_mutex_init(&t.lock, NULL);
+
+   printf("%d parties %ux%u, %s contre %s, %ld thread(s), graine %llu\n",
+    nbGames, nbLines, nbColumns, get_level_name(levels[0]),
+    get_level_name(levels[1]), nbThreads, (unsigned long long)seed);
+   fflush(stdout);
+
+   const double START = get_time();
+
+   pthread_t *threads = malloc(sizeof(pthread_t) * nbThreads);
+   long nbStarted = 0;
+   if(threads != NULL){
+      while(nbStarted < nbThreads
+       && !pthread_create(&threads[nbStarted], NULL, run_worker, &t)){
+         ++nbStarted;
+      }
+   }
+   //without any thread, the main one plays the games
+   if(nbStarted == 0){
+      run_worker(&t);
+   }
+   for(long i = 0; i < nbStarted; ++i){
+      pthread_join(threads[i], NULL);
+   }
+   free(threads);
+
+   const double SECONDS = get_time() - START;
+   pthread_mutex_destroy(&t.lock);
+
+   if(t.failed || t.nbPlayed < t.nbGames){
+      printf("Mémoire insuffisante: %u partie(s) jouée(s) sur %u.\n",
+       t.nbPlayed, t.nbGames);
+      status = -1;
+   }
+
+   if(t.nbPlayed > 0){
+      printf("Premier ordinateur (%s): %u victoire(s), %u nul(s), %u défaite(s)\n",
+       get_level_name(levels[0]), t.wins[0], t.draws, t.wins[1]);
+      printf("%.2f s, %.2f parties/s, %.1f coups/s (%llu coups)\n", SECONDS,
+       t.nbPlayed / SECONDS, t.nbMoves / SECONDS, t.nbMoves);
+   }
+
+   if(t.nbLatencies > 0){
+      qsort(t.latencies, t.nbLatencies, sizeof(double), compare_times);
+
+      double total = 0;
+      for(size_t i = 0; i < t.nbLatencies; ++i){
+         total += t.latencies[i];
+      }
+
+      printf("Temps par coup (ms): moyenne %.3f, min %.3f, p50 %.3f, "
+       "p90 %.3f, p99 %.3f, p99.9 %.3f, max %.3f\n",
+       1000 * total / t.nbLatencies, 1000 * t.latencies[0],
+       1000 * get_percentile(t.latencies, t.nbLatencies, 50),
+       1000 * get_percentile(t.latencies, t.nbLatencies, 90),
+       1000 * get_percentile(t.latencies, t.nbLatencies, 99),
+       1000 * get_percentile(t.latencies, t.nbLatencies, 99.9),
+       1000 * t.latencies[t.nbLatencies - 1]);
+   }
+
+   free(t.latencies);
+
+   return (status == -1) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// ----------- STATIC FUNCTIONS --------------------
+
+static int read_level(const char *name, Level *level){
+   assert(name != NULL && level != NULL);
+
+   if(!strcmp(name, "facile")){
+      *level = easy;
+   }
+   else if(!strcmp(name, "difficile")){
+      *level = hard;
+   }
+   else if(!strcmp(name, "montecarlo")){
+      *level = montecarlo;
+   }
+   else{
+      return -1;
+   }
+
+   return 1;
+}
+
+static const char *get_level_name(Level level){
+   switch(level){
+      case easy:
+         return "facile";
+
+      case hard:
+         return "difficile";
+
+      default:
+         return "montecarlo";
+   }
+}
+
+static void *run_worker(void *data){
+   assert(data != NULL);
+
+   Tournament *t = data;
+
+   Worker w;
+   memset(&w, 0, sizeof(Worker));
+   w.t = t;
+
+   //every thread has the models of both computers
+   int failed = 0;
+   for(unsigned k = 0; k < 2; ++k){
+      w.models[k] = create_model(t->nbLines, t->nbColumns);
+      if(w.models[k] == NULL){
+         failed = 1;
+         continue;
+      }
+      set_level(w.models[k], t->levels[k]);
+      set_move_time(w.models[k], t->moveTime);
+      //the games are already played in parallel
+      set_nb_threads(w.models[k], 1);
+      if(set_table_size(w.models[k], t->tableSize) == -1){
+         failed = 1;
+      }
+   }
+
+   unsigned i;
+   while(!failed
+    && (i = __atomic_fetch_add(&t->next, 1, __ATOMIC_RELAXED)) < t->nbGames){
+      unsigned nbMoves = 0;
+      int winner = play_game(&w, i, &nbMoves);
+      if(winner == -2){
+         failed = 1;
+         break;
+      }
+
+      pthread_mutex_lock(&t->lock);
+      if(winner == -1){
+         ++t->draws;
+      }
+      else{
+         ++t->wins[winner];
+      }
+      ++t->nbPlayed;
+      t->nbMoves += nbMoves;
+      pthread_mutex_unlock(&t->lock);
+   }
+
+   //the times of the thread are added to the others
+   pthread_mutex_lock(&t->lock);
+   if(failed){
+      t->failed = 1;
+   }
+   if(w.nbLatencies > 0){
+      double *latencies = realloc(t->latencies,
+       sizeof(double) * (t->nbLatencies + w.nbLatencies));
+      if(latencies != NULL){
+         memcpy(latencies + t->nbLatencies, w.latencies,
+          sizeof(double) * w.nbLatencies);
+         t->latencies = latencies;
+         t->nbLatencies += w.nbLatencies;
+      }
+   }
+   pthread_mutex_unlock(&t->lock);
+
+   free(w.latencies);
+   free_model(w.models[0]);
+   free_model(w.models[1]);
+   return NULL;
+}
+
+static int play_game(Worker *w, unsigned index, unsigned *nbMoves){
+   assert(w != NULL && nbMoves != NULL);
+
+   Tournament *t = w->t;
+   const unsigned NBCELLS = t->nbLines * t->nbColumns;
+
+   //red always starts, played by the first computer in the even games
+   const unsigned FIRST = index % 2;
+   for(unsigned k = 0; k < 2; ++k){
+      Colour colour = (k == FIRST) ? red : yellow;
+      //the player of a model is the other computer
+      initialise_game_model(w->models[k], (colour == red) ? yellow : red);
+      set_first_colour(w->models[k], red);
+      set_seed(w->models[k], t->seed + 2 * (uint64_t)index + k);
+   }
+
+   for(unsigned n = 0; n < NBCELLS; ++n){
+      const unsigned k = (n % 2 == 0) ? FIRST : 1 - FIRST;
+
+      const double START = get_time();
+      unsigned column = choose_column_ai(w->models[k]);
+      const double LATENCY = get_time() - START;
+
+      if(w->nbLatencies == w->capacity){
+         size_t capacity = w->capacity ? 2 * w->capacity : LATENCIES_START;
+         double *latencies = realloc(w->latencies, sizeof(double) * capacity);
+         if(latencies == NULL){
+            return -2;
+         }
+         w->latencies = latencies;
+         w->capacity = capacity;
+      }
+      w->latencies[w->nbLatencies++] = LATENCY;
+
+      Result result = lose;
+      Result other = lose;
+      play_token_ai(w->models[k], column, &result);
+      add_token_player(w->models[1 - k], column, &other);
+      *nbMoves = n + 1;
+
+      if(result == win){
+         return (int)k;
+      }
+   }
+
+   return -1;
+}
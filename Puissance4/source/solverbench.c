@@ -0,0 +1,339 @@
+/**
+ * @file solverbench.c
+ *
+ * @author Alyssia Kayembe S211023 & Jiaxiang Yao S214174
+ *
+ * @brief Program measuring how fast the "A.I." of a Connect 4 solves
+ *  positions (without any window)
+ *
+ * @remark Each line of the file gives a position as the moves leading to it
+ * (see play_moves(), the numbers being separated by commas above 9 columns),
+ * optionally followed by its expected score. The position is searched until
+ * the grid is full, which gives its exact score: 0 for a draw, otherwise
+ * positive if the colour whose turn it is wins, 1 if it wins with its last
+ * token, 2 with the one before... (negative if it loses). This is the score of
+ * the usual test sets of 6x7. The positions are grouped by the part of the
+ * game they belong to, from the number of tokens in the grid: beginning (less
+ * than a third of the cells), middle and end (two thirds or more). Every group
+ * gives the mean time, the mean number of nodes and the 99th percentile of
+ * the time of its positions. Each position starts with an empty
+ * transposition table.
+ *
+ * @date 18-10-26
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <getopt.h>
+
+#include "model.h"
+#include "ai.h"
+#include "timing.h"
+
+//longest line of the file (100x100 moves separated by commas)
+#define LINE_LENGTH 65536
+//parts of the game
+#define NBBUCKETS 3
+
+/**
+ * @brief Implementation of the results of a part of the game
+ */
+typedef struct bucket_t{
+   const char *name;
+   //time of each position in seconds
+   double *times;
+   size_t nbPositions;
+   size_t capacity;
+   unsigned long long nodes;
+   //positions whose score isn't the expected one
+   unsigned errors;
+}Bucket;
+
+//_________DECLARATION OF THE STATIC FUNCTIONS____________
+
+/**
+ * @brief Solves the position of the model
+ *
+ * @param mp pointer on the model.
+ * @param nodes a pointer that will store the number of nodes searched.
+ *
+ * @pre mp != NULL, nodes != NULL, the game isn't over
+ * @post returns the exact score of the position (see the top of the file).
+ */
+static int solve_position(Model *mp, unsigned long long *nodes);
+
+/**
+ * @brief Adds the time of a position to a part of the game
+ *
+ * @param bucket the part of the game.
+ * @param seconds the time of the position.
+ *
+ * @pre bucket != NULL
+ * @post returns 1 if the time has been added, -1 otherwise.
+ */
+static int add_time(Bucket *bucket, double seconds);
+
+/**
+ * @brief Prints the results of a part of the game
+ *
+ * @param bucket the part of the game.
+ * @param checked 1 if the file gave expected scores.
+ *
+ * @pre bucket != NULL
+ * @post the number of positions, the mean time, the mean number of nodes
+ * and the 99th percentile of the time are printed (the times get sorted).
+ */
+static void print_bucket(Bucket *bucket, int checked);
+
+//________END OF THE DECLARATION__________________________
+
+int main(int argc, char *argv[]){
+
+   char *optstring = ":l:c:t:j:qH";
+   int option = 0;
+   int status = 0;
+
+   unsigned nbLines = 6, nbColumns = 7;
+   int tableSize = 64;
+   int nbThreads = 1;
+   int quiet = 0;
+
+   while(((option = getopt(argc, argv, optstring)) != EOF) && status != -1){
+      switch(option){
+         case 'l':
+            nbLines = atoi(optarg);
+            break;
+
+         case 'c':
+            nbColumns = atoi(optarg);
+            break;
+
+         case 't':
+            tableSize = atoi(optarg);
+            break;
+
+         case 'j':
+            nbThreads = atoi(optarg);
+            break;
+
+         case 'q':
+            quiet = 1;
+            break;
+
+         case 'H':
+            printf("UTILISATION: solverbench [options] [fichier]\n");
+            printf("Chaque ligne du fichier (l'entrée standard par défaut) donne les coups d'une position, éventuellement suivis de son score.\n");
+            printf("AIDE OPTIONS:\n");
+            printf("-l <nombre de lignes>: nombre de lignes du plateau (6 par défaut).\n");
+            printf("-c <nombre de colonnes>: nombre de colonnes du plateau (7 par défaut).\n");
+            printf("-t <taille en Mo>: taille de la table de transposition (64 par défaut).\n");
+            printf("-j <nombre de threads>: threads de la recherche (1 par défaut).\n");
+            printf("-q: n'affiche pas le résultat de chaque position.\n");
+            return EXIT_SUCCESS;
+
+         case '?':
+            printf("Option inconnue: %c\n", optopt);
+            status = -1;
+            break;
+
+         case ':':
+            printf("Argument manquant: %c\n", optopt);
+            status = -1;
+            break;
+
+         default:
+            printf("Une erreur inconnue s'est produite\n");
+            status = -1;
+            break;
+      }
+   }
+
+   if(status == -1){
+      printf("Une erreur au niveau des options est survenue!\n");
+      return EXIT_FAILURE;
+   }
+
+   if(nbLines < 4 || nbLines > 100 || nbColumns < 4 || nbColumns > 100
+    || tableSize < 0 || nbThreads < 1){
+      printf("Les options choisies sont invalides.\n");
+      return EXIT_FAILURE;
+   }
+
+   FILE *file = stdin;
+   if(optind < argc && strcmp(argv[optind], "-")){
+      file = fopen(argv[optind], "r");
+      if(file == NULL){
+         printf("Impossible d'ouvrir le fichier %s\n", argv[optind]);
+         return EXIT_FAILURE;
+      }
+   }
+
+   char *line = malloc(LINE_LENGTH);
+   Model *mp = create_model(nbLines, nbColumns);
+   if(line == NULL || mp == NULL || set_table_size(mp, tableSize) == -1){
+      printf("Mémoire insuffisante.\n");
+      free(line);
+      free_model(mp);
+      if(file != stdin){
+         fclose(file);
+      }
+      return EXIT_FAILURE;
+   }
+   set_nb_threads(mp, (unsigned)nbThreads);
+
+   const unsigned NBCELLS = nbLines * nbColumns;
+   Bucket buckets[NBBUCKETS];
+   memset(buckets, 0, sizeof(buckets));
+   buckets[0].name = "début";
+   buckets[1].name = "milieu";
+   buckets[2].name = "fin";
+
+   unsigned lineNumber = 0;
+   unsigned nbInvalid = 0;
+   int checked = 0;
+   while(status != -1 && fgets(line, LINE_LENGTH, file) != NULL){
+      ++lineNumber;
+
+      //the moves, then the expected score
+      char *moves = strtok(line, " \t\r\n");
+      if(moves == NULL || moves[0] == '#'){
+         continue;
+      }
+      char *expected = strtok(NULL, " \t\r\n");
+
+      //each position starts with an empty table
+      initialise_game_model(mp, red);
+      int nbMoves = play_moves(mp, moves);
+      int over = (nbMoves == -1 || (unsigned)nbMoves == NBCELLS);
+      if(!over && nbMoves > 0){
+         const unsigned LAST = get_move(mp, nbMoves - 1);
+         over = check_alignment(mp,
+          (unsigned)(get_cases_left(mp)[LAST] + 1), LAST);
+      }
+      if(over){
+         printf("Ligne %u: position invalide ou partie finie, ignorée\n",
+          lineNumber);
+         ++nbInvalid;
+         continue;
+      }
+
+      unsigned long long nodes = 0;
+      const double START = get_time();
+      const int SCORE = solve_position(mp, &nodes);
+      const double SECONDS = get_time() - START;
+
+      Bucket *bucket = &buckets[(3 * (unsigned)nbMoves) / NBCELLS];
+      if(add_time(bucket, SECONDS) == -1){
+         printf("Mémoire insuffisante.\n");
+         status = -1;
+         break;
+      }
+      bucket->nodes += nodes;
+
+      int wrong = 0;
+      if(expected != NULL){
+         checked = 1;
+         wrong = (atoi(expected) != SCORE);
+         bucket->errors += wrong;
+      }
+
+      if(!quiet){
+         printf("%s %d (%.6f s, %llu noeuds)%s\n", moves, SCORE, SECONDS,
+          nodes, wrong ? " ERREUR" : "");
+         fflush(stdout);
+      }
+   }
+
+   if(file != stdin){
+      fclose(file);
+   }
+
+   printf("%-8s %10s %14s %16s %14s%s\n", "partie", "positions",
+    "temps moyen", "noeuds moyens", "temps p99", checked ? "    erreurs" : "");
+   unsigned nbErrors = 0;
+   for(unsigned b = 0; b < NBBUCKETS; ++b){
+      print_bucket(&buckets[b], checked);
+      nbErrors += buckets[b].errors;
+      free(buckets[b].times);
+   }
+   if(nbInvalid > 0){
+      printf("%u ligne(s) ignorée(s)\n", nbInvalid);
+   }
+
+   free(line);
+   free_model(mp);
+
+   if(status == -1 || nbErrors > 0){
+      return EXIT_FAILURE;
+   }
+   return EXIT_SUCCESS;
+}
+
+// ----------- STATIC FUNCTIONS --------------------
+
+static int solve_position(Model *mp, unsigned long long *nodes){
+   assert(mp != NULL && nodes != NULL);
+
+   const unsigned NBCELLS = get_nbLines(mp) * get_nbColumns(mp);
+   const unsigned NBMOVES = get_nb_moves(mp);
+
+   //searching until the grid is full gives the exact score
+   SearchInfo info;
+   search_best_column(mp, NBCELLS - NBMOVES, &info);
+   *nodes = info.nodes;
+
+   if(info.score < SCORE_WIN && info.score > -SCORE_WIN){
+      return 0;
+   }
+
+   //SCORE_WIN + the cells left after the winning move
+   const int CELLSLEFT = (info.score > 0) ? info.score - SCORE_WIN
+    : -info.score - SCORE_WIN;
+   const int SCORE = (CELLSLEFT + 2) / 2;
+   return (info.score > 0) ? SCORE : -SCORE;
+}
+
+static int add_time(Bucket *bucket, double seconds){
+   assert(bucket != NULL);
+
+   if(bucket->nbPositions == bucket->capacity){
+      size_t capacity = bucket->capacity ? 2 * bucket->capacity : 256;
+      double *times = realloc(bucket->times, sizeof(double) * capacity);
+      if(times == NULL){
+         return -1;
+      }
+      bucket->times = times;
+      bucket->capacity = capacity;
+   }
+   bucket->times[bucket->nbPositions++] = seconds;
+
+   return 1;
+}
+
+static void print_bucket(Bucket *bucket, int checked){
+   assert(bucket != NULL);
+
+   if(bucket->nbPositions == 0){
+      printf("%-8s %10d %14s %16s %14s%s\n", bucket->name, 0, "-", "-", "-",
+       checked ? "          -" : "");
+      return;
+   }
+
+   double total = 0;
+   for(size_t i = 0; i < bucket->nbPositions; ++i){
+      total += bucket->times[i];
+   }
+
+   qsort(bucket->times, bucket->nbPositions, sizeof(double), compare_times);
+
+   printf("%-8s %10zu %12.3fms %16.0f %12.3fms", bucket->name,
+    bucket->nbPositions, 1000 * total / bucket->nbPositions,
+    (double)bucket->nodes / bucket->nbPositions,
+    1000 * get_percentile(bucket->times, bucket->nbPositions, 99));
+   if(checked){
+      printf(" %10u", bucket->errors);
+   }
+   printf("\n");
+}
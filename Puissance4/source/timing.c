@@ -0,0 +1,47 @@
+/**
+ * @file timing.c
+ *
+ * @author Alyssia Kayembe S211023 & Jiaxiang Yao S214174
+ *
+ * @brief File implementing the measure of the time of the searches of a
+ *  Connect 4, and the statistics of the times measured
+ *
+ * @date 18-10-26
+ */
+
+//clock_gettime
+#define _POSIX_C_SOURCE 199309L
+
+#include <time.h>
+#include <stddef.h>
+#include <assert.h>
+
+#include "timing.h"
+
+double get_time(void){
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+
+   return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+int compare_times(const void *a, const void *b){
+   assert(a != NULL && b != NULL);
+
+   double x = *(const double *)a;
+   double y = *(const double *)b;
+   return (x > y) - (x < y);
+}
+
+double get_percentile(const double *times, size_t nbTimes, double percent){
+   assert(times != NULL && nbTimes > 0);
+
+   size_t rank = (size_t)(percent / 100 * nbTimes + 0.999999);
+   if(rank == 0){
+      rank = 1;
+   }
+   if(rank > nbTimes){
+      rank = nbTimes;
+   }
+   return times[rank - 1];
+}
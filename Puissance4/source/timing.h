@@ -0,0 +1,50 @@
+/**
+ * @file timing.h
+ *
+ * @author Alyssia Kayembe S211023 & Jiaxiang Yao S214174
+ *
+ * @brief Header of the file containing the measure of the time of the
+ *  searches of a Connect 4, and the statistics of the times measured
+ *
+ * @date 18-10-26
+ */
+
+#ifndef ___TIMING___
+#define ___TIMING___
+
+#include <stddef.h>
+
+/**
+ * @brief Gives the time elapsed since an arbitrary point (monotonic clock)
+ *
+ * @pre /
+ * @post returns the time in seconds.
+ */
+double get_time(void);
+
+/**
+ * @brief Compares two times (for qsort)
+ *
+ * @param a pointer on the first time.
+ * @param b pointer on the second time.
+ *
+ * @pre a != NULL, b != NULL
+ * @post returns a negative, zero or positive number if the first time is
+ * smaller, equal or greater than the second one.
+ */
+int compare_times(const void *a, const void *b);
+
+/**
+ * @brief Gives a percentile of sorted times
+ *
+ * @param times the times, sorted (see compare_times()).
+ * @param nbTimes number of times.
+ * @param percent the percentile wanted (0 to 100).
+ *
+ * @pre times != NULL, nbTimes > 0
+ * @post returns the smallest time such that percent % of the times are lower
+ * or equal.
+ */
+double get_percentile(const double *times, size_t nbTimes, double percent);
+
+#endif //___TIMING___
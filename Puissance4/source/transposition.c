@@ -0,0 +1,191 @@
+/**
+ * @file transposition.c
+ *
+ * @author Alyssia Kayembe S211023 & Jiaxiang Yao S214174
+ *
+ * @brief File implementing all the functions forming the transposition table
+ *  of the "A.I." of a Connect 4
+ *
+ * @date 18-10-26
+ */
+
+//posix_memalign
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "transposition.h"
+
+#define CACHE_LINE 64
+#define BUCKET_SIZE 4
+#define MAX_DEPTH 255
+
+/**
+ * @brief Implementation of an entry of the table (16 bytes)
+ *
+ * @remark The data holds, from the lowest bits, the score (32 bits), the
+ * depth, the bound + 1 (0 if the entry is empty), the column + 1 (0 if there
+ * isn't any) and the age (8 bits each). The key is stored xored with the
+ * data: if two threads write the same entry at the same time, the key and
+ * the data of the entry don't match anymore and the entry is simply ignored.
+ */
+typedef struct entry_t{
+   uint64_t check;
+   uint64_t data;
+}Entry;
+
+/**
+ * @brief Implementation of a bucket of entries (one cache line)
+ */
+typedef struct bucket_t{
+   Entry entries[BUCKET_SIZE];
+}Bucket;
+
+/**
+ * @brief Implementation of the transposition table
+ */
+struct transposition_table_t{
+   Bucket *buckets;
+   //the number of buckets is a power of 2
+   uint64_t mask;
+   uint8_t age;
+};
+
+//_________DECLARATION OF THE STATIC FUNCTIONS____________
+
+/**
+ * @brief Reads an entry of the table (both words are read atomically)
+ *
+ * @param entry the entry.
+ * @param key a pointer that will store the key of the entry.
+ *
+ * @pre entry != NULL, key != NULL
+ * @post returns the data of the entry.
+ */
+static uint64_t read_entry(Entry *entry, uint64_t *key);
+
+//________END OF THE DECLARATION__________________________
+
+TranspositionTable *create_table(unsigned megabytes){
+   assert(megabytes > 0);
+
+   TranspositionTable *tp = malloc(sizeof(TranspositionTable));
+   if(tp == NULL){
+      return NULL;
+   }
+
+   //the biggest power of 2 of buckets that fits in the memory given
+   uint64_t nbBuckets = 1;
+   while(nbBuckets * 2 * sizeof(Bucket) <= (uint64_t)megabytes << 20){
+      nbBuckets *= 2;
+   }
+
+   void *memory = NULL;
+   if(posix_memalign(&memory, CACHE_LINE, nbBuckets * sizeof(Bucket))){
+      free(tp);
+      return NULL;
+   }
+
+   tp->buckets = memory;
+   tp->mask = nbBuckets - 1;
+   clear_table(tp);
+
+   return tp;
+}
+
+void free_table(TranspositionTable *tp){
+   if(tp == NULL){
+      return;
+   }
+   free(tp->buckets);
+   free(tp);
+}
+
+void clear_table(TranspositionTable *tp){
+   assert(tp != NULL);
+
+   memset(tp->buckets, 0, (tp->mask + 1) * sizeof(Bucket));
+   tp->age = 0;
+}
+
+void new_search_table(TranspositionTable *tp){
+   assert(tp != NULL);
+
+   ++tp->age;
+}
+
+void store_entry(TranspositionTable *tp, uint64_t key, int score,
+ unsigned depth, Bound bound, int column){
+   assert(tp != NULL);
+
+   Bucket *bucket = &tp->buckets[key & tp->mask];
+
+   //the same position, or else the shallowest entry (the older ones first)
+   Entry *replaced = NULL;
+   unsigned replacedDepth = 0;
+   int oldReplaced = 0;
+   for(unsigned i = 0; i < BUCKET_SIZE; ++i){
+      Entry *entry = &bucket->entries[i];
+      uint64_t entryKey;
+      uint64_t data = read_entry(entry, &entryKey);
+      if(entryKey == key){
+         replaced = entry;
+         break;
+      }
+
+      unsigned entryDepth = (data >> 32) & 0xFF;
+      int oldEntry = (uint8_t)(data >> 56) != tp->age;
+      if(replaced == NULL || oldEntry > oldReplaced
+       || (oldEntry == oldReplaced && entryDepth < replacedDepth)){
+         replaced = entry;
+         replacedDepth = entryDepth;
+         oldReplaced = oldEntry;
+      }
+   }
+
+   if(depth > MAX_DEPTH){
+      depth = MAX_DEPTH;
+   }
+   uint64_t data = (uint64_t)(uint32_t)score | (uint64_t)depth << 32
+    | (uint64_t)(uint8_t)(bound + 1) << 40
+    | (uint64_t)(uint8_t)(column + 1) << 48 | (uint64_t)tp->age << 56;
+
+   __atomic_store_n(&replaced->check, key ^ data, __ATOMIC_RELAXED);
+   __atomic_store_n(&replaced->data, data, __ATOMIC_RELAXED);
+}
+
+int probe_entry(TranspositionTable *tp, uint64_t key, int *score,
+ unsigned *depth, Bound *bound, int *column){
+   assert(tp != NULL && score != NULL && depth != NULL && bound != NULL
+    && column != NULL);
+
+   Bucket *bucket = &tp->buckets[key & tp->mask];
+
+   for(unsigned i = 0; i < BUCKET_SIZE; ++i){
+      uint64_t entryKey;
+      uint64_t data = read_entry(&bucket->entries[i], &entryKey);
+      uint8_t entryBound = (data >> 40) & 0xFF;
+      if(entryKey == key && entryBound){
+         *score = (int32_t)(uint32_t)data;
+         *depth = (data >> 32) & 0xFF;
+         *bound = (Bound)(entryBound - 1);
+         *column = (int)((data >> 48) & 0xFF) - 1;
+         return 1;
+      }
+   }
+
+   return 0;
+}
+
+// ----------- STATIC FUNCTIONS --------------------
+
+static uint64_t read_entry(Entry *entry, uint64_t *key){
+   assert(entry != NULL && key != NULL);
+
+   uint64_t data = __atomic_load_n(&entry->data, __ATOMIC_RELAXED);
+   *key = __atomic_load_n(&entry->check, __ATOMIC_RELAXED) ^ data;
+   return data;
+}
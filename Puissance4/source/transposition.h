@@ -0,0 +1,110 @@
+/**
+ * @file transposition.h
+ *
+ * @author Alyssia Kayembe S211023 & Jiaxiang Yao S214174
+ *
+ * @brief Header of the file containing all the functions forming the
+ *  transposition table of the "A.I." of a Connect 4
+ *
+ * @remark The table stores, for the positions already searched (identified by
+ * their Zobrist key), the score found, the kind of bound it is and the best
+ * column. The entries are grouped by buckets of the size of a cache line, so
+ * a lookup only costs one memory access.
+ * Several threads can use the same table at the same time without any lock:
+ * an entry damaged by two simultaneous writes is never returned.
+ *
+ * @date 18-10-26
+ */
+
+#ifndef ___TRANSPOSITION___
+#define ___TRANSPOSITION___
+
+#include <stdint.h>
+
+typedef enum{exact, lowerBound, upperBound}Bound;
+
+/**
+ * @brief Declaration of the TranspositionTable opaque type
+ */
+typedef struct transposition_table_t TranspositionTable;
+
+/**
+ * @brief Creates a transposition table
+ *
+ * @param megabytes memory the table may use (in MB).
+ *
+ * @pre megabytes > 0
+ * @post returns the address of the table (using at most the memory given),
+ *  NULL if something went wrong.
+ */
+TranspositionTable *create_table(unsigned megabytes);
+
+/**
+ * @brief Frees a transposition table
+ *
+ * @param tp pointer on the table.
+ *
+ * @pre /
+ * @post the table is freed.
+ */
+void free_table(TranspositionTable *tp);
+
+/**
+ * @brief Removes every entry of a transposition table
+ *
+ * @param tp pointer on the table.
+ *
+ * @pre tp != NULL
+ * @post the table is empty.
+ */
+void clear_table(TranspositionTable *tp);
+
+/**
+ * @brief Tells the table that a new search starts, so that the entries of
+ *  the previous ones are replaced first
+ *
+ * @param tp pointer on the table.
+ *
+ * @pre tp != NULL, no search uses the table
+ * @post the age of the table is increased.
+ */
+void new_search_table(TranspositionTable *tp);
+
+/**
+ * @brief Stores the result of the search of a position
+ *
+ * @param tp pointer on the table.
+ * @param key Zobrist key of the position.
+ * @param score score found.
+ * @param depth depth of the search.
+ * @param bound exact if the score is exact, lowerBound or upperBound if the
+ * search was cut.
+ * @param column best column found (-1 if there isn't any).
+ *
+ * @pre tp != NULL
+ * @post the entry is stored, replacing the least useful one of its bucket.
+ */
+void store_entry(TranspositionTable *tp, uint64_t key, int score,
+ unsigned depth, Bound bound, int column);
+
+/**
+ * @brief Looks for a position in the table
+ *
+ * @param tp pointer on the table.
+ * @param key Zobrist key of the position.
+ * @param score a pointer that will store the score found.
+ * @param depth a pointer that will store the depth of the search.
+ * @param bound a pointer that will store the kind of bound of the score.
+ * @param column a pointer that will store the best column (-1 if unknown).
+ *
+ * @pre tp != NULL, score != NULL, depth != NULL, bound != NULL,
+ *  column != NULL
+ * @post the data is stored in the pointers if the position was found.
+ *
+ * @return int 1 if the position was found,
+ *         int 0 otherwise.
+ */
+int probe_entry(TranspositionTable *tp, uint64_t key, int *score,
+ unsigned *depth, Bound *bound, int *column);
+
+#endif //___TRANSPOSITION___
@@ -151,7 +151,8 @@ void initialise_images(View *vp){
       const unsigned L = get_nbLines(vp->mp);
       Colour **grid = get_grid(vp->mp);
 
-      for(unsigned i = 0; i < L; ++i){
+      //no grid if the memory is lacking: the cells are left empty
+      for(unsigned i = 0; i < L && grid != NULL; ++i){
          for(unsigned j = 0; j < C; ++j){
             update_image(vp, i, j, grid[i][j]);
          }
@@ -179,7 +180,8 @@ void update_image(View *vp, unsigned posL, unsigned posC, Colour colour){
       const unsigned C = get_nbColumns(vp->mp);
       const unsigned L = get_nbLines(vp->mp);
 
-      for(unsigned i = 0; i < L; ++i){
+      //no grid if the memory is lacking: the cells are left empty
+      for(unsigned i = 0; i < L && grid != NULL; ++i){
          for(unsigned j = 0; j < C; ++j){
             GtkWidget *image = gtk_image_new_from_pixbuf(vp->pixBToasts[grid[i][j]]);
             gtk_table_attach(GTK_TABLE(vp->table), image, j, j + 1,